@@ -2,44 +2,19 @@
 #define MYSTL_ALLOC_H_
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <new>
 
-namespace mystl {
-
-# ifdef __USE_MALLOC
-typedef __malloc_alloc_template<0> malloc_alloc;
-typedef malloc_alloc alloc;
-# else 
-// 令alloc为第二级配置器
-typedef __default_alloc_template<__NODE_ALLOCATOR_THREADS, 0> alloc;
-
+#ifndef __THROW_BAD_ALLOC
+# define __THROW_BAD_ALLOC throw std::bad_alloc()
 #endif
 
-// allocate 统一接口
-template<class T, class Alloc>
-class simple_alloc {
-public:
-    static T *allocate(size_t n)
-    {
-        return 0 == n ? 0 : (T*)Alloc::allocate(n * sizeof(T));
-    }
-
-    static T *allocate(void)
-    {
-        return (T*)Alloc::allocate(sizeof(T));
-    }
-
-    static T *deallocate(T *p, size_t n)
-    {
-        if (0 != n) {
-            Alloc::deallocate(p, n * sizeof(T));
-        }
-    }
+// 第二级配置器的free list不加锁
+#ifndef __NODE_ALLOCATOR_THREADS
+# define __NODE_ALLOCATOR_THREADS false
+#endif
 
-    static T *deallocate(T *p)
-    {
-        Alloc::deallocate(p, sizeof(T));
-    }
-};
+namespace mystl {
 
 // 第一级配置器
 template <int inst>
@@ -47,12 +22,12 @@ class __malloc_alloc_template {
 private:
     // 以下函数处理内存不足的情况
     // oom : out of memory
-    static void *my_oom_malloc(size_t)
+    static void *my_oom_malloc(size_t n)
     {
         void (* my_malloc_handler)();
         void *result;
         for (;;) {
-            my_malloc_handler = __malloc_alloc_omm_handler;
+            my_malloc_handler = my__malloc_alloc_oom_handler;
             if (0 == my_malloc_handler) {
                 __THROW_BAD_ALLOC;
             }
@@ -63,12 +38,12 @@ private:
             }
         }
     }
-    static void *my_oom_realloc(void*, size_t)
+    static void *my_oom_realloc(void *p, size_t n)
     {
         void (* my_malloc_handler)();
         void *result;
         for (;;) {
-            my_malloc_handler = __malloc_alloc_omm_handler;
+            my_malloc_handler = my__malloc_alloc_oom_handler;
             if (0 == my_malloc_handler) {
                 __THROW_BAD_ALLOC;
             }
@@ -80,7 +55,7 @@ private:
             }
         }
     }
-    static void (* my__malloc_alloc_oom_handler)() = 0;
+    static void (* my__malloc_alloc_oom_handler)();
 
 public:
     static void *allocate(size_t n)
@@ -112,12 +87,15 @@ public:
     // 可以通过它指定自己的out-of-memory handler
     static void (* set_malloc_hander(void (*f)())) ()
     {
-        void (* old()) () = my__malloc_alloc_oom_handler;
+        void (* old) () = my__malloc_alloc_oom_handler;
         my__malloc_alloc_oom_handler = f;
         return old;
     }
 };
 
+template <int inst>
+void (* __malloc_alloc_template<inst>::my__malloc_alloc_oom_handler)() = 0;
+
 typedef __malloc_alloc_template<0> malloc_alloc;
 
 /*******************************************************************************************/
@@ -138,7 +116,7 @@ private:
 private:
     union obj {
         union obj *free_list_link; // 指向相同形式的另一个obj
-        char client_data[i]; // 指向实际区块
+        char client_data[1]; // 指向实际区块
     };
 
 private:
@@ -161,13 +139,14 @@ private:
     static char *end_free;  // 内存池结束位置
     static size_t heap_size;
 
+public:
     static void *allocate(size_t n)
     {
         obj *volatile *my_free_list;
         obj *result = nullptr;
         // 大于128就调用第一级配置器
         if (n > (size_t)__MAX_BYTES) {
-            return (malloc_alloc::allocate(n);)
+            return (malloc_alloc::allocate(n));
         }
         // 寻找16个free list中适当的一个
         my_free_list = free_list + FREELIST_INDEX(n);
@@ -181,7 +160,7 @@ private:
         return (result);
     }
 
-    static void *deallocate(void *p, size_t n)
+    static void deallocate(void *p, size_t n)
     {
         obj *q = (obj *)p;
         obj *volatile *my_free_list;
@@ -202,11 +181,13 @@ private:
 // static data member 的定义与初值设定
 template <bool threads, int inst>
 char *__default_alloc_template<threads, inst>::start_free = 0;
-char *__default_alloc_template<thread, inst>::end_free = 0;
+template <bool threads, int inst>
+char *__default_alloc_template<threads, inst>::end_free = 0;
+template <bool threads, int inst>
 size_t __default_alloc_template<threads, inst>::heap_size = 0;
 
 template <bool threads, int inst>
-__default_alloc_template<threads, inst>::obj * volatile
+typename __default_alloc_template<threads, inst>::obj * volatile
 __default_alloc_template<threads, inst>::free_list[__NFREELISTS]
     = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
@@ -281,7 +262,7 @@ char* __default_alloc_template<threads, inst>::chunk_alloc(size_t size, int &nob
         return result;
     } else {
         // 内存池剩余空间连一个区块的大小都无法提供
-        size_t bytes_to_get = 2 * total_bytes + ROUND_UP(head_size >> 4);
+        size_t bytes_to_get = 2 * total_bytes + ROUND_UP(heap_size >> 4);
         // 以下让内存池中的残余零头还有利用价值
         if (bytes_left > 0) {
             // 内存池内还有一些零头，先配给适当的free list
@@ -296,13 +277,13 @@ char* __default_alloc_template<threads, inst>::chunk_alloc(size_t size, int &nob
         start_free = (char *)malloc(bytes_to_get);
         if (start_free == 0) {
             // heap空间不足，malloc失败
-            int i;
+            size_t i;
             obj *volatile *my_free_list, *p;
             // 试着检视我们手上拥有的东西，这不会造成伤害。
             // 我们不打算尝试配置较小的区块，因为那在多线程机器上容易导致灾难
             // 以下搜寻适当的free list
             // 所谓适当是指“尚有未用区块，且区块够大”的free list
-            for (i = size; i <= __MAX_BYTES; i+=__ALIGN) {
+            for (i = size; i <= (size_t)__MAX_BYTES; i += __ALIGN) {
                 my_free_list = free_list + FREELIST_INDEX(i);
                 p = *my_free_list;
                 if (p != 0) {
@@ -329,9 +310,41 @@ char* __default_alloc_template<threads, inst>::chunk_alloc(size_t size, int &nob
 
 }
 
+# ifdef __USE_MALLOC
+typedef malloc_alloc alloc;
+# else 
+// 令alloc为第二级配置器
+typedef __default_alloc_template<__NODE_ALLOCATOR_THREADS, 0> alloc;
 
-}
+#endif
+
+// allocate 统一接口
+template<class T, class Alloc>
+class simple_alloc {
+public:
+    static T *allocate(size_t n)
+    {
+        return 0 == n ? 0 : (T*)Alloc::allocate(n * sizeof(T));
+    }
+
+    static T *allocate(void)
+    {
+        return (T*)Alloc::allocate(sizeof(T));
+    }
+
+    static void deallocate(T *p, size_t n)
+    {
+        if (0 != n) {
+            Alloc::deallocate(p, n * sizeof(T));
+        }
+    }
 
+    static void deallocate(T *p)
+    {
+        Alloc::deallocate(p, sizeof(T));
+    }
+};
 
+}
 
-#endif
\ No newline at end of file
+#endif
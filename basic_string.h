@@ -0,0 +1,555 @@
+#ifndef MYSTL_BASIC_STRING_H_
+#define MYSTL_BASIC_STRING_H_
+
+#include <stddef.h>
+#include <string.h>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "alloc.h"
+#include "iterator.h"
+#include "uninitialized.h"
+
+/**
+ * @brief 带短字符串优化（SSO）的basic_string
+ * 对象本身占3个指针的大小（64位平台为24字节）。短字符串直接存放在对象内部：
+ *   char版本最多可放23个字符，最后一个字符位置存放“剩余容量”，字符串恰好23个字符时它正好为0，兼作结尾的'\0'。
+ * 超出部分才向simple_alloc<CharT, Alloc>配置堆空间；Alloc缺省为第二级配置器，
+ * 因此128字节以内的缓冲区直接取自free list，不经过malloc。
+ * 对象最后一个字节的最高位区分两种存放方式：长字符串在容量字段中置上该位。
+ * 复制字符使用uninitialized_copy()，char/wchar_t会落到memmove特化版本上；
+ * char版本的find()在支持SSE2时一次比较16个字符，compare()交给memcmp。
+ */
+
+namespace mystl {
+
+// 字符的通用操作，逐个字符处理
+template <class CharT>
+struct __string_ops {
+    static size_t length(const CharT *s)
+    {
+        const CharT *p = s;
+        while (*p != CharT()) {
+            ++p;
+        }
+        return p - s;
+    }
+
+    static int compare(const CharT *a, const CharT *b, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i) {
+            if (a[i] < b[i]) {
+                return -1;
+            }
+            if (b[i] < a[i]) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    static const CharT *find(const CharT *first, const CharT *last, CharT c)
+    {
+        for (; first != last; ++first) {
+            if (*first == c) {
+                return first;
+            }
+        }
+        return last;
+    }
+
+    // 在[first, last)中寻找长度为n的子串s，找不到时返回last
+    static const CharT *search(const CharT *first, const CharT *last, const CharT *s, size_t n)
+    {
+        for (; size_t(last - first) >= n; ++first) {
+            first = find(first, last - n + 1, s[0]);
+            if (first == last - n + 1) {
+                break;
+            }
+            if (0 == compare(first, s, n)) {
+                return first;
+            }
+        }
+        return last;
+    }
+};
+
+// char特化版：SSE2一次比较16个字符，其余交给libc
+template <>
+struct __string_ops<char> {
+    static size_t length(const char *s)
+    {
+        return strlen(s);
+    }
+
+    static int compare(const char *a, const char *b, size_t n)
+    {
+        return 0 == n ? 0 : memcmp(a, b, n);
+    }
+
+    static const char *find(const char *first, const char *last, char c)
+    {
+#ifdef __SSE2__
+        const __m128i needle = _mm_set1_epi8(c);
+        for (; last - first >= 16; first += 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)first);
+            int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+            if (mask) {
+                return first + __builtin_ctz(mask);
+            }
+        }
+#endif
+        for (; first != last; ++first) {
+            if (*first == c) {
+                return first;
+            }
+        }
+        return last;
+    }
+
+    /**
+     * @brief 子串查找
+     * 同时比较子串首字符与尾字符：16个候选位置一次筛选，只有两端都吻合的位置才用memcmp核对
+     */
+    static const char *search(const char *first, const char *last, const char *s, size_t n)
+    {
+        if (1 == n) {
+            return find(first, last, s[0]);
+        }
+        const char *stop = last - n + 1; // 候选起点的上界
+#ifdef __SSE2__
+        const __m128i head = _mm_set1_epi8(s[0]);
+        const __m128i tail = _mm_set1_epi8(s[n - 1]);
+        for (; stop - first >= 16; first += 16) {
+            __m128i a = _mm_loadu_si128((const __m128i *)first);
+            __m128i b = _mm_loadu_si128((const __m128i *)(first + n - 1));
+            int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, head), _mm_cmpeq_epi8(b, tail)));
+            while (mask) {
+                int i = __builtin_ctz(mask);
+                if (0 == memcmp(first + i + 1, s + 1, n - 2)) {
+                    return first + i;
+                }
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; first < stop; ++first) {
+            if (*first == s[0] && first[n - 1] == s[n - 1] && 0 == memcmp(first + 1, s + 1, n - 2)) {
+                return first;
+            }
+        }
+        return last;
+    }
+};
+
+template <class CharT, class Alloc = mystl::alloc>
+class basic_string {
+public:
+    typedef CharT               value_type;
+    typedef value_type*         pointer;
+    typedef const value_type*   const_pointer;
+    typedef value_type*         iterator;
+    typedef const value_type*   const_iterator;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef ptrdiff_t           difference_type;
+
+    static const size_type npos = size_type(-1);
+
+protected:
+    typedef mystl::simple_alloc<value_type, Alloc> data_allocator;
+    typedef __string_ops<CharT> ops;
+
+    struct __long {
+        pointer data;
+        size_type size;
+        size_type cap;  // 含标志位
+    };
+
+    enum {__SMALL_CAP = sizeof(__long) / sizeof(CharT) - 1}; // char为23
+
+    union {
+        __long l;
+        CharT s[__SMALL_CAP + 1];
+    } rep;
+
+    // 长字符串的标志位：落在对象最后一个字节的最高位上
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    static size_type long_flag() { return size_type(0x80); }
+    static size_type encode_cap(size_type n) { return (n << 8) | long_flag(); }
+    static size_type decode_cap(size_type c) { return c >> 8; }
+#else
+    static size_type long_flag() { return size_type(1) << (sizeof(size_type) * 8 - 1); }
+    static size_type encode_cap(size_type n) { return n | long_flag(); }
+    static size_type decode_cap(size_type c) { return c & ~long_flag(); }
+#endif
+
+    bool is_long() const
+    {
+        return 0 != (((const unsigned char *)&rep)[sizeof(rep) - 1] & 0x80);
+    }
+
+    void set_small_size(size_type n)
+    {
+        rep.s[__SMALL_CAP] = CharT(__SMALL_CAP - n);
+        rep.s[n] = CharT();
+    }
+
+    // 堆空间多配置一个结尾字符，并按8字节（第二级配置器的对齐边界）上调，免得浪费零头
+    static size_type heap_cap(size_type n)
+    {
+        size_type bytes = ((n + 1) * sizeof(CharT) + 7) & ~size_type(7);
+        return bytes / sizeof(CharT) - 1;
+    }
+
+    void init(const CharT *p, size_type n)
+    {
+        if (n <= __SMALL_CAP) {
+            mystl::uninitialized_copy(p, p + n, rep.s);
+            set_small_size(n);
+        } else {
+            size_type cap = heap_cap(n);
+            pointer buf = data_allocator::allocate(cap + 1);
+            mystl::uninitialized_copy(p, p + n, buf);
+            buf[n] = CharT();
+            rep.l.data = buf;
+            rep.l.size = n;
+            rep.l.cap = encode_cap(cap);
+        }
+    }
+
+    void deallocate()
+    {
+        if (is_long()) {
+            data_allocator::deallocate(rep.l.data, capacity() + 1);
+        }
+    }
+
+    void set_size(size_type n)
+    {
+        if (is_long()) {
+            rep.l.size = n;
+            rep.l.data[n] = CharT();
+        } else {
+            set_small_size(n);
+        }
+    }
+
+    // 重新配置容量为n的堆空间，保留原有内容
+    void reallocate(size_type n)
+    {
+        size_type len = size();
+        size_type cap = heap_cap(n);
+        pointer buf = data_allocator::allocate(cap + 1);
+        mystl::uninitialized_copy((const CharT *)data(), (const CharT *)data() + len, buf);
+        buf[len] = CharT();
+        deallocate();
+        rep.l.data = buf;
+        rep.l.size = len;
+        rep.l.cap = encode_cap(cap);
+    }
+
+    // 确保能再容纳n个字符，不够时按几何级数增长
+    void grow_by(size_type n)
+    {
+        size_type need = size() + n;
+        if (need > capacity()) {
+            size_type twice = 2 * capacity();
+            reallocate(need > twice ? need : twice);
+        }
+    }
+
+public:
+    basic_string()
+    {
+        set_small_size(0);
+    }
+
+    basic_string(const CharT *p)
+    {
+        init(p, ops::length(p));
+    }
+
+    basic_string(const CharT *p, size_type n)
+    {
+        init(p, n);
+    }
+
+    basic_string(size_type n, CharT c)
+    {
+        set_small_size(0);
+        append(n, c);
+    }
+
+    basic_string(const basic_string& x)
+    {
+        init(x.data(), x.size());
+    }
+
+    basic_string(basic_string&& x)
+    {
+        rep = x.rep;
+        x.set_small_size(0);
+    }
+
+    ~basic_string()
+    {
+        deallocate();
+    }
+
+    basic_string& operator=(const basic_string& x)
+    {
+        if (this != &x) {
+            clear();
+            append(x.data(), x.size());
+        }
+        return *this;
+    }
+
+    basic_string& operator=(basic_string&& x)
+    {
+        if (this != &x) {
+            deallocate();
+            rep = x.rep;
+            x.set_small_size(0);
+        }
+        return *this;
+    }
+
+    basic_string& operator=(const CharT *p)
+    {
+        return assign(p, ops::length(p));
+    }
+
+    // 以[p, p+n)取代现有内容，p可以指向自身
+    basic_string& assign(const CharT *p, size_type n)
+    {
+        pointer d = data();
+        if (p >= d && p < d + size()) {
+            // 来源在目的之后（或相同），由前往后逐个搬移不会覆盖尚未读取的字符
+            for (size_type i = 0; i < n; ++i) {
+                d[i] = p[i];
+            }
+            set_size(n);
+            return *this;
+        }
+        clear();
+        return append(p, n);
+    }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size(); }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size(); }
+
+    pointer data() { return is_long() ? rep.l.data : rep.s; }
+    const_pointer data() const { return is_long() ? rep.l.data : rep.s; }
+    const_pointer c_str() const { return data(); }
+
+    size_type size() const
+    {
+        return is_long() ? rep.l.size : size_type(__SMALL_CAP - rep.s[__SMALL_CAP]);
+    }
+
+    size_type length() const { return size(); }
+
+    size_type capacity() const
+    {
+        return is_long() ? decode_cap(rep.l.cap) : size_type(__SMALL_CAP);
+    }
+
+    bool empty() const { return 0 == size(); }
+
+    reference operator[](size_type n) { return data()[n]; }
+    const_reference operator[](size_type n) const { return data()[n]; }
+    reference front() { return *data(); }
+    reference back() { return data()[size() - 1]; }
+
+    void reserve(size_type n)
+    {
+        if (n > capacity()) {
+            reallocate(n);
+        }
+    }
+
+    void clear()
+    {
+        set_size(0);
+    }
+
+    void push_back(CharT c)
+    {
+        grow_by(1);
+        size_type n = size();
+        data()[n] = c;
+        set_size(n + 1);
+    }
+
+    void pop_back()
+    {
+        set_size(size() - 1);
+    }
+
+    basic_string& append(const CharT *p, size_type n)
+    {
+        // p可能指向自身，扩容时reallocate()先复制旧内容再释放，所以先记下偏移
+        const_pointer old = data();
+        bool inside = p >= old && p < old + size();
+        size_type offset = p - old;
+        grow_by(n);
+        if (inside) {
+            p = data() + offset;
+        }
+        size_type len = size();
+        mystl::uninitialized_copy(p, p + n, data() + len);
+        set_size(len + n);
+        return *this;
+    }
+
+    basic_string& append(const CharT *p)
+    {
+        return append(p, ops::length(p));
+    }
+
+    basic_string& append(const basic_string& x)
+    {
+        return append(x.data(), x.size());
+    }
+
+    basic_string& append(size_type n, CharT c)
+    {
+        grow_by(n);
+        size_type len = size();
+        pointer p = data() + len;
+        for (size_type i = 0; i < n; ++i) {
+            p[i] = c;
+        }
+        set_size(len + n);
+        return *this;
+    }
+
+    basic_string& operator+=(const basic_string& x) { return append(x); }
+    basic_string& operator+=(const CharT *p) { return append(p); }
+    basic_string& operator+=(CharT c) { push_back(c); return *this; }
+
+    void resize(size_type n, CharT c = CharT())
+    {
+        size_type len = size();
+        if (n > len) {
+            append(n - len, c);
+        } else {
+            set_size(n);
+        }
+    }
+
+    void swap(basic_string& x)
+    {
+        std::swap(rep, x.rep);
+    }
+
+    // 从pos开始寻找字符c
+    size_type find(CharT c, size_type pos = 0) const
+    {
+        size_type len = size();
+        if (pos >= len) {
+            return npos;
+        }
+        const_pointer first = data();
+        const_pointer r = ops::find(first + pos, first + len, c);
+        return r == first + len ? npos : size_type(r - first);
+    }
+
+    // 从pos开始寻找长度为n的子串p
+    size_type find(const CharT *p, size_type pos, size_type n) const
+    {
+        size_type len = size();
+        if (pos > len || n > len - pos) {
+            return npos;
+        }
+        if (0 == n) {
+            return pos;
+        }
+        const_pointer first = data();
+        const_pointer r = ops::search(first + pos, first + len, p, n);
+        return r == first + len ? npos : size_type(r - first);
+    }
+
+    size_type find(const CharT *p, size_type pos = 0) const
+    {
+        return find(p, pos, ops::length(p));
+    }
+
+    size_type find(const basic_string& x, size_type pos = 0) const
+    {
+        return find(x.data(), pos, x.size());
+    }
+
+    int compare(const CharT *p, size_type n) const
+    {
+        size_type len = size();
+        int r = ops::compare(data(), p, len < n ? len : n);
+        if (r != 0) {
+            return r;
+        }
+        return len < n ? -1 : (len > n ? 1 : 0);
+    }
+
+    int compare(const basic_string& x) const
+    {
+        return compare(x.data(), x.size());
+    }
+
+    int compare(const CharT *p) const
+    {
+        return compare(p, ops::length(p));
+    }
+};
+
+template <class CharT, class Alloc>
+inline bool operator==(const basic_string<CharT, Alloc>& a, const basic_string<CharT, Alloc>& b)
+{
+    return a.size() == b.size() && 0 == a.compare(b);
+}
+
+template <class CharT, class Alloc>
+inline bool operator!=(const basic_string<CharT, Alloc>& a, const basic_string<CharT, Alloc>& b)
+{
+    return !(a == b);
+}
+
+template <class CharT, class Alloc>
+inline bool operator<(const basic_string<CharT, Alloc>& a, const basic_string<CharT, Alloc>& b)
+{
+    return a.compare(b) < 0;
+}
+
+template <class CharT, class Alloc>
+inline bool operator==(const basic_string<CharT, Alloc>& a, const CharT *b)
+{
+    return 0 == a.compare(b);
+}
+
+template <class CharT, class Alloc>
+inline basic_string<CharT, Alloc> operator+(const basic_string<CharT, Alloc>& a, const basic_string<CharT, Alloc>& b)
+{
+    basic_string<CharT, Alloc> result;
+    result.reserve(a.size() + b.size());
+    result.append(a);
+    result.append(b);
+    return result;
+}
+
+template <class CharT, class Alloc>
+inline void swap(basic_string<CharT, Alloc>& a, basic_string<CharT, Alloc>& b)
+{
+    a.swap(b);
+}
+
+typedef basic_string<char>      string;
+typedef basic_string<wchar_t>   wstring;
+
+}
+
+#endif
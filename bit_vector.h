@@ -0,0 +1,549 @@
+#ifndef MYSTL_BIT_VECTOR_H_
+#define MYSTL_BIT_VECTOR_H_
+
+#include <stddef.h>
+#include <string.h>
+#include "alloc.h"
+#include "iterator.h"
+
+/**
+ * @brief 按位压缩的bit_vector
+ * 与SGI STL的bit_vector一样，每个元素只占1位，以__bit_reference作为代理引用，
+ * __bit_iterator是随机访问迭代器，可以交给iterator_traits萃取。
+ * 整体操作（set/reset/flip/&=/|=/^=）以64位字为单位处理，循环体简单，编译器可以向量化；
+ * count()使用popcount，find_first()/find_next()使用ctz跳过全0的字。
+ * 最后一个字中超出size()的位始终保持为0，所以上述操作不必另外处理尾部。
+ * rank()/select()依赖build_rank_index()建立的索引，修改位之后须重新建立。
+ */
+
+namespace mystl {
+
+typedef unsigned long __bit_word;
+enum {__WORD_BIT = int(sizeof(__bit_word) * 8)};
+
+inline size_t __bit_popcount(__bit_word x)
+{
+    return __builtin_popcountl(x);
+}
+
+inline size_t __bit_ctz(__bit_word x)
+{
+    return __builtin_ctzl(x);
+}
+
+// 代理引用：指向某个字中的某一位
+struct __bit_reference {
+    __bit_word *p;
+    __bit_word mask;
+
+    __bit_reference(__bit_word *x, __bit_word m) : p(x), mask(m) {}
+
+    operator bool() const
+    {
+        return !(!(*p & mask));
+    }
+
+    __bit_reference& operator=(bool x)
+    {
+        if (x) {
+            *p |= mask;
+        } else {
+            *p &= ~mask;
+        }
+        return *this;
+    }
+
+    __bit_reference& operator=(const __bit_reference& x)
+    {
+        return *this = bool(x);
+    }
+
+    bool operator==(const __bit_reference& x) const
+    {
+        return bool(*this) == bool(x);
+    }
+
+    void flip()
+    {
+        *p ^= mask;
+    }
+};
+
+struct __bit_iterator {
+    typedef random_access_iterator_tag  iterator_category;
+    typedef bool                        value_type;
+    typedef ptrdiff_t                   difference_type;
+    typedef __bit_reference*            pointer;
+    typedef __bit_reference             reference;
+
+    __bit_word *p;
+    unsigned int offset;
+
+    __bit_iterator() : p(0), offset(0) {}
+    __bit_iterator(__bit_word *x, unsigned int y) : p(x), offset(y) {}
+
+    void bump_up()
+    {
+        if (offset++ == __WORD_BIT - 1) {
+            offset = 0;
+            ++p;
+        }
+    }
+
+    void bump_down()
+    {
+        if (offset-- == 0) {
+            offset = __WORD_BIT - 1;
+            --p;
+        }
+    }
+
+    reference operator*() const { return reference(p, __bit_word(1) << offset); }
+
+    __bit_iterator& operator++() { bump_up(); return *this; }
+    __bit_iterator operator++(int) { __bit_iterator tmp = *this; bump_up(); return tmp; }
+    __bit_iterator& operator--() { bump_down(); return *this; }
+    __bit_iterator operator--(int) { __bit_iterator tmp = *this; bump_down(); return tmp; }
+
+    __bit_iterator& operator+=(difference_type i)
+    {
+        difference_type n = i + offset;
+        p += n / __WORD_BIT;
+        n = n % __WORD_BIT;
+        if (n < 0) {
+            offset = (unsigned int)n + __WORD_BIT;
+            --p;
+        } else {
+            offset = (unsigned int)n;
+        }
+        return *this;
+    }
+
+    __bit_iterator& operator-=(difference_type i) { return *this += -i; }
+    __bit_iterator operator+(difference_type i) const { __bit_iterator tmp = *this; return tmp += i; }
+    __bit_iterator operator-(difference_type i) const { __bit_iterator tmp = *this; return tmp -= i; }
+
+    difference_type operator-(const __bit_iterator& x) const
+    {
+        return __WORD_BIT * (p - x.p) + offset - x.offset;
+    }
+
+    reference operator[](difference_type i) const { return *(*this + i); }
+
+    bool operator==(const __bit_iterator& x) const { return p == x.p && offset == x.offset; }
+    bool operator!=(const __bit_iterator& x) const { return !(*this == x); }
+    bool operator<(const __bit_iterator& x) const { return p < x.p || (p == x.p && offset < x.offset); }
+    bool operator>(const __bit_iterator& x) const { return x < *this; }
+    bool operator<=(const __bit_iterator& x) const { return !(x < *this); }
+    bool operator>=(const __bit_iterator& x) const { return !(*this < x); }
+};
+
+template <class Alloc = mystl::alloc>
+class basic_bit_vector {
+public:
+    typedef bool                value_type;
+    typedef size_t              size_type;
+    typedef ptrdiff_t           difference_type;
+    typedef __bit_reference     reference;
+    typedef bool                const_reference;
+    typedef __bit_iterator      iterator;
+
+    static const size_type npos = size_type(-1);
+
+protected:
+    typedef mystl::simple_alloc<__bit_word, Alloc> data_allocator;
+    typedef mystl::simple_alloc<size_type, Alloc> index_allocator;
+
+    enum {__SUPER_WORDS = 8}; // rank索引每512位记录一次累计值
+
+    __bit_word *start;
+    size_type nbits;
+    size_type nwords_cap;
+    size_type *rank_index;      // rank_index[k]为前k个超级块中1的个数
+    size_type rank_index_len;
+
+    static size_type words_for(size_type n)
+    {
+        return (n + __WORD_BIT - 1) / __WORD_BIT;
+    }
+
+    size_type nwords() const
+    {
+        return words_for(nbits);
+    }
+
+    // 清除最后一个字中超出size()的位
+    void sanitize()
+    {
+        size_type r = nbits % __WORD_BIT;
+        if (r) {
+            start[nbits / __WORD_BIT] &= (__bit_word(1) << r) - 1;
+        }
+    }
+
+    void reallocate(size_type nwords_new)
+    {
+        __bit_word *tmp = data_allocator::allocate(nwords_new);
+        size_type used = nwords();
+        if (used) {
+            memcpy(tmp, start, used * sizeof(__bit_word));
+        }
+        memset(tmp + used, 0, (nwords_new - used) * sizeof(__bit_word));
+        if (start) {
+            data_allocator::deallocate(start, nwords_cap);
+        }
+        start = tmp;
+        nwords_cap = nwords_new;
+    }
+
+    void free_rank_index()
+    {
+        if (rank_index) {
+            index_allocator::deallocate(rank_index, rank_index_len);
+            rank_index = 0;
+            rank_index_len = 0;
+        }
+    }
+
+public:
+    basic_bit_vector() : start(0), nbits(0), nwords_cap(0), rank_index(0), rank_index_len(0) {}
+
+    explicit basic_bit_vector(size_type n, bool value = false)
+        : start(0), nbits(0), nwords_cap(0), rank_index(0), rank_index_len(0)
+    {
+        resize(n, value);
+    }
+
+    basic_bit_vector(const basic_bit_vector& x)
+        : start(0), nbits(0), nwords_cap(0), rank_index(0), rank_index_len(0)
+    {
+        *this = x;
+    }
+
+    basic_bit_vector& operator=(const basic_bit_vector& x)
+    {
+        if (this != &x) {
+            free_rank_index();
+            size_type old_words = nwords();
+            nbits = 0;
+            if (nwords_cap < x.nwords()) {
+                reallocate(x.nwords());
+                old_words = 0; // 新空间已全部清零
+            }
+            nbits = x.nbits;
+            if (nbits) {
+                memcpy(start, x.start, nwords() * sizeof(__bit_word));
+            }
+            // 原先使用、如今超出nwords()的整字须清零，保持“size()之后的位皆为0”
+            if (old_words > nwords()) {
+                memset(start + nwords(), 0, (old_words - nwords()) * sizeof(__bit_word));
+            }
+        }
+        return *this;
+    }
+
+    ~basic_bit_vector()
+    {
+        free_rank_index();
+        if (start) {
+            data_allocator::deallocate(start, nwords_cap);
+        }
+    }
+
+    iterator begin() { return iterator(start, 0); }
+    iterator end() { return begin() + difference_type(nbits); }
+
+    size_type size() const { return nbits; }
+    size_type capacity() const { return nwords_cap * __WORD_BIT; }
+    bool empty() const { return 0 == nbits; }
+
+    // 底层的字数组，供批量处理
+    __bit_word *words() { return start; }
+    const __bit_word *words() const { return start; }
+    size_type word_count() const { return nwords(); }
+
+    reference operator[](size_type n)
+    {
+        return reference(start + n / __WORD_BIT, __bit_word(1) << (n % __WORD_BIT));
+    }
+
+    bool operator[](size_type n) const
+    {
+        return test(n);
+    }
+
+    bool test(size_type n) const
+    {
+        return 0 != (start[n / __WORD_BIT] & (__bit_word(1) << (n % __WORD_BIT)));
+    }
+
+    void reserve(size_type n)
+    {
+        if (words_for(n) > nwords_cap) {
+            reallocate(words_for(n));
+        }
+    }
+
+    void push_back(bool x)
+    {
+        if (nbits == capacity()) {
+            reallocate(nwords_cap ? 2 * nwords_cap : 1);
+        }
+        ++nbits;
+        (*this)[nbits - 1] = x;
+    }
+
+    void pop_back()
+    {
+        --nbits;
+        sanitize();
+    }
+
+    void resize(size_type n, bool value = false)
+    {
+        size_type old = nbits;
+        if (words_for(n) > nwords_cap) {
+            size_type twice = 2 * nwords_cap;
+            reallocate(words_for(n) > twice ? words_for(n) : twice);
+        }
+        nbits = n;
+        if (n < old) {
+            sanitize();
+            // 缩小后多出的整字也须清零，以便再次扩大时为0
+            size_type used = nwords();
+            size_type old_words = words_for(old);
+            if (old_words > used) {
+                memset(start + used, 0, (old_words - used) * sizeof(__bit_word));
+            }
+        } else if (value) {
+            for (size_type i = old; i < n && i % __WORD_BIT; ++i) {
+                (*this)[i] = true;
+            }
+            size_type w = words_for(old);
+            for (; w < nwords(); ++w) {
+                start[w] = ~__bit_word(0);
+            }
+            sanitize();
+        }
+    }
+
+    void clear()
+    {
+        resize(0);
+    }
+
+    /*******************************************************************************************/
+    // 单个位与整体的set/reset/flip
+
+    basic_bit_vector& set(size_type n, bool value = true)
+    {
+        (*this)[n] = value;
+        return *this;
+    }
+
+    basic_bit_vector& reset(size_type n)
+    {
+        return set(n, false);
+    }
+
+    basic_bit_vector& flip(size_type n)
+    {
+        (*this)[n].flip();
+        return *this;
+    }
+
+    basic_bit_vector& set()
+    {
+        size_type n = nwords();
+        for (size_type i = 0; i < n; ++i) {
+            start[i] = ~__bit_word(0);
+        }
+        sanitize();
+        return *this;
+    }
+
+    basic_bit_vector& reset()
+    {
+        size_type n = nwords();
+        for (size_type i = 0; i < n; ++i) {
+            start[i] = 0;
+        }
+        return *this;
+    }
+
+    basic_bit_vector& flip()
+    {
+        size_type n = nwords();
+        for (size_type i = 0; i < n; ++i) {
+            start[i] = ~start[i];
+        }
+        sanitize();
+        return *this;
+    }
+
+    // 以下三个操作要求两者size()相同
+    basic_bit_vector& operator&=(const basic_bit_vector& x)
+    {
+        size_type n = nwords();
+        const __bit_word *src = x.start;
+        for (size_type i = 0; i < n; ++i) {
+            start[i] &= src[i];
+        }
+        return *this;
+    }
+
+    basic_bit_vector& operator|=(const basic_bit_vector& x)
+    {
+        size_type n = nwords();
+        const __bit_word *src = x.start;
+        for (size_type i = 0; i < n; ++i) {
+            start[i] |= src[i];
+        }
+        return *this;
+    }
+
+    basic_bit_vector& operator^=(const basic_bit_vector& x)
+    {
+        size_type n = nwords();
+        const __bit_word *src = x.start;
+        for (size_type i = 0; i < n; ++i) {
+            start[i] ^= src[i];
+        }
+        return *this;
+    }
+
+    /*******************************************************************************************/
+    // 查询
+
+    // 值为1的位数
+    size_type count() const
+    {
+        size_type n = nwords();
+        size_type result = 0;
+        for (size_type i = 0; i < n; ++i) {
+            result += __bit_popcount(start[i]);
+        }
+        return result;
+    }
+
+    bool any() const
+    {
+        return npos != find_first();
+    }
+
+    bool none() const
+    {
+        return !any();
+    }
+
+    bool all() const
+    {
+        return count() == nbits;
+    }
+
+    // 第一个值为1的位，没有时返回npos
+    size_type find_first() const
+    {
+        return find_from(0);
+    }
+
+    // pos之后第一个值为1的位，没有时返回npos
+    size_type find_next(size_type pos) const
+    {
+        return pos + 1 >= nbits ? npos : find_from(pos + 1);
+    }
+
+    /**
+     * @brief 建立rank/select的索引
+     * 每8个字（512位）记录一次此前1的累计个数，rank()只需再对不超过8个字做popcount
+     */
+    void build_rank_index()
+    {
+        free_rank_index();
+        size_type n = nwords();
+        rank_index_len = n / __SUPER_WORDS + 1;
+        rank_index = index_allocator::allocate(rank_index_len);
+        size_type total = 0;
+        for (size_type i = 0; i < n; ++i) {
+            if (0 == i % __SUPER_WORDS) {
+                rank_index[i / __SUPER_WORDS] = total;
+            }
+            total += __bit_popcount(start[i]);
+        }
+        if (0 == n % __SUPER_WORDS) {
+            rank_index[n / __SUPER_WORDS] = total;
+        }
+    }
+
+    // [0, pos)中1的个数，须先build_rank_index()
+    size_type rank(size_type pos) const
+    {
+        size_type w = pos / __WORD_BIT;
+        size_type result = rank_index[w / __SUPER_WORDS];
+        for (size_type i = w - w % __SUPER_WORDS; i < w; ++i) {
+            result += __bit_popcount(start[i]);
+        }
+        size_type r = pos % __WORD_BIT;
+        if (r) {
+            result += __bit_popcount(start[w] & ((__bit_word(1) << r) - 1));
+        }
+        return result;
+    }
+
+    // 第k个（从0起算）值为1的位的位置，不存在时返回npos；须先build_rank_index()
+    size_type select(size_type k) const
+    {
+        size_type n = nwords();
+        if (0 == n) {
+            return npos;
+        }
+        // 二分查找最后一个累计值不超过k的超级块
+        size_type lo = 0;
+        size_type hi = (n - 1) / __SUPER_WORDS;
+        while (lo < hi) {
+            size_type mid = (lo + hi + 1) / 2;
+            if (rank_index[mid] <= k) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        k -= rank_index[lo];
+        for (size_type i = lo * __SUPER_WORDS; i < n; ++i) {
+            size_type c = __bit_popcount(start[i]);
+            if (k < c) {
+                __bit_word x = start[i];
+                for (; k > 0; --k) {
+                    x &= x - 1; // 清除最低位的1
+                }
+                return i * __WORD_BIT + __bit_ctz(x);
+            }
+            k -= c;
+        }
+        return npos;
+    }
+
+private:
+    size_type find_from(size_type pos) const
+    {
+        size_type n = nwords();
+        size_type i = pos / __WORD_BIT;
+        if (i >= n) {
+            return npos;
+        }
+        __bit_word x = start[i] & (~__bit_word(0) << (pos % __WORD_BIT));
+        while (0 == x) {
+            if (++i == n) {
+                return npos;
+            }
+            x = start[i];
+        }
+        return i * __WORD_BIT + __bit_ctz(x);
+    }
+};
+
+typedef basic_bit_vector<> bit_vector;
+
+}
+
+#endif
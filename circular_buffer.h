@@ -0,0 +1,227 @@
+#ifndef MYSTL_CIRCULAR_BUFFER_H_
+#define MYSTL_CIRCULAR_BUFFER_H_
+
+#include <stddef.h>
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "util.h"
+
+/**
+ * @brief 固定容量的环形缓冲区
+ * 容量上调为2的幂，以位与代替取模。head与tail是只增不减的逻辑位置，元素个数即tail - head，
+ * 实际下标为pos & mask，因此在尾端加入、在头端移除都是O(1)，不必像Vector::erase(begin())那样搬动元素。
+ * 满时的行为由mode决定：overwrite_oldest覆盖最旧的元素（滑动窗口），reject_when_full拒绝加入。
+ * 元素在空间中至多分成两段连续区间，array_one()/array_two()以column_span给出这两段，
+ * 可以直接交给SIMD运算或writev，无需先复制到连续空间。
+ */
+
+namespace mystl {
+
+enum circular_buffer_mode {
+    overwrite_oldest,
+    reject_when_full
+};
+
+template <class T, class Ref, class Ptr>
+struct __circular_iterator {
+    typedef __circular_iterator<T, T&, T*>              iterator;
+    typedef __circular_iterator                         self;
+
+    typedef random_access_iterator_tag  iterator_category;
+    typedef T                           value_type;
+    typedef Ptr                         pointer;
+    typedef Ref                         reference;
+    typedef ptrdiff_t                   difference_type;
+
+    T *buffer;
+    size_t mask;
+    size_t pos;         // 逻辑位置
+
+    __circular_iterator() : buffer(0), mask(0), pos(0) {}
+    __circular_iterator(T *b, size_t m, size_t p) : buffer(b), mask(m), pos(p) {}
+    __circular_iterator(const iterator& x) : buffer(x.buffer), mask(x.mask), pos(x.pos) {}
+    __circular_iterator& operator=(const __circular_iterator&) = default;
+
+    reference operator*() const { return buffer[pos & mask]; }
+    pointer operator->() const { return &buffer[pos & mask]; }
+
+    self& operator++() { ++pos; return *this; }
+    self operator++(int) { self tmp = *this; ++pos; return tmp; }
+    self& operator--() { --pos; return *this; }
+    self operator--(int) { self tmp = *this; --pos; return tmp; }
+
+    self& operator+=(difference_type n) { pos += n; return *this; }
+    self& operator-=(difference_type n) { pos -= n; return *this; }
+    self operator+(difference_type n) const { return self(buffer, mask, pos + n); }
+    self operator-(difference_type n) const { return self(buffer, mask, pos - n); }
+    difference_type operator-(const self& x) const { return difference_type(pos - x.pos); }
+
+    reference operator[](difference_type n) const { return buffer[(pos + n) & mask]; }
+
+    bool operator==(const self& x) const { return pos == x.pos; }
+    bool operator!=(const self& x) const { return pos != x.pos; }
+    bool operator<(const self& x) const { return difference_type(pos - x.pos) < 0; }
+    bool operator>(const self& x) const { return x < *this; }
+    bool operator<=(const self& x) const { return !(x < *this); }
+    bool operator>=(const self& x) const { return !(*this < x); }
+};
+
+template <class T, class Ref, class Ptr>
+inline __circular_iterator<T, Ref, Ptr> operator+(ptrdiff_t n, const __circular_iterator<T, Ref, Ptr>& x)
+{
+    return x + n;
+}
+
+template <class T, class Alloc = mystl::alloc>
+class circular_buffer {
+public:
+    typedef T                   value_type;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef ptrdiff_t           difference_type;
+
+    typedef __circular_iterator<T, T&, T*>              iterator;
+    typedef __circular_iterator<T, const T&, const T*>  const_iterator;
+
+protected:
+    typedef simple_alloc<value_type, Alloc> data_allocator;
+
+    T *buffer;
+    size_type mask;             // 容量减一
+    size_type head;             // 最旧元素的逻辑位置
+    size_type tail;             // 最新元素的下一个逻辑位置
+    circular_buffer_mode policy;
+
+public:
+    /**
+     * @brief 配置容纳capacity个元素的空间
+     * capacity上调为2的幂（至少为1），capacity()返回上调后的值；
+     * 因此overwrite_oldest模式下保留的是“最近的capacity()个”元素，例如capacity为5时保留最近的8个
+     */
+    explicit circular_buffer(size_type capacity, circular_buffer_mode m = overwrite_oldest)
+        : head(0), tail(0), policy(m)
+    {
+        size_type n = __ring_round_up(capacity);
+        buffer = data_allocator::allocate(n);
+        mask = n - 1;
+    }
+
+    circular_buffer(const circular_buffer& x) : head(0), tail(0), policy(x.policy)
+    {
+        buffer = data_allocator::allocate(x.capacity());
+        mask = x.mask;
+        for (const_iterator p = x.begin(); p != x.end(); ++p) {
+            push_back(*p);
+        }
+    }
+
+    ~circular_buffer()
+    {
+        clear();
+        data_allocator::deallocate(buffer, capacity());
+    }
+
+    iterator begin() { return iterator(buffer, mask, head); }
+    iterator end() { return iterator(buffer, mask, tail); }
+    const_iterator begin() const { return const_iterator(buffer, mask, head); }
+    const_iterator end() const { return const_iterator(buffer, mask, tail); }
+
+    size_type size() const { return tail - head; }
+    size_type capacity() const { return mask + 1; }
+    bool empty() const { return tail == head; }
+    bool full() const { return size() == capacity(); }
+    circular_buffer_mode mode() const { return policy; }
+
+    // 第i个元素，0为最旧的
+    reference operator[](size_type i) { return buffer[(head + i) & mask]; }
+    const_reference operator[](size_type i) const { return buffer[(head + i) & mask]; }
+
+    reference front() { return buffer[head & mask]; }
+    reference back() { return buffer[(tail - 1) & mask]; }
+    const_reference front() const { return buffer[head & mask]; }
+    const_reference back() const { return buffer[(tail - 1) & mask]; }
+
+    /**
+     * @brief 在尾端加入x
+     * 已满时：overwrite_oldest模式以x覆盖最旧的元素并返回true；reject_when_full模式不做任何事，返回false
+     */
+    bool push_back(const T& x)
+    {
+        if (full()) {
+            if (reject_when_full == policy) {
+                return false;
+            }
+            buffer[head & mask] = x; // 最旧元素的位置即新元素的位置
+            ++head;
+            ++tail;
+            return true;
+        }
+        mystl::construct(buffer + (tail & mask), x);
+        ++tail;
+        return true;
+    }
+
+    void pop_front()
+    {
+        mystl::destroy(buffer + (head & mask));
+        ++head;
+    }
+
+    void pop_back()
+    {
+        --tail;
+        mystl::destroy(buffer + (tail & mask));
+    }
+
+    void clear()
+    {
+        while (!empty()) {
+            pop_front();
+        }
+        head = tail = 0;
+    }
+
+    /**
+     * @brief 元素所在的两段连续区间
+     * array_one()为从最旧元素开始的一段，array_two()为绕回空间开头的一段（可能为空）；
+     * 依次处理两段即按从旧到新的顺序访问所有元素
+     */
+    column_span<T> array_one()
+    {
+        column_span<T> s = { buffer + (head & mask), first_span_size() };
+        return s;
+    }
+
+    column_span<T> array_two()
+    {
+        column_span<T> s = { buffer, size() - first_span_size() };
+        return s;
+    }
+
+    column_span<const T> array_one() const
+    {
+        column_span<const T> s = { buffer + (head & mask), first_span_size() };
+        return s;
+    }
+
+    column_span<const T> array_two() const
+    {
+        column_span<const T> s = { buffer, size() - first_span_size() };
+        return s;
+    }
+
+private:
+    size_type first_span_size() const
+    {
+        size_type to_end = capacity() - (head & mask);
+        return size() < to_end ? size() : to_end;
+    }
+
+    circular_buffer& operator=(const circular_buffer&);
+};
+
+}
+
+#endif
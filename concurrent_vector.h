@@ -0,0 +1,258 @@
+#ifndef MYSTL_CONCURRENT_VECTOR_H_
+#define MYSTL_CONCURRENT_VECTOR_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <new>
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+
+/**
+ * @brief 可并发追加的分段向量 concurrent_vector
+ * Vector在insert_aux()中重新配置空间并搬移全部元素，多个线程同时push_back只能加全局锁。
+ * concurrent_vector把元素放在一组大小按几何级数增长的segment中：
+ *   segment 0 容纳 [0, B)，segment k (k >= 1) 容纳 [B * 2^(k-1), B * 2^k)，B = 2^base_bits。
+ * segment一经配置就不再移动，因此元素地址始终稳定。
+ * push_back/grow_by以fetch_add预留下标；用到尚未配置的segment时，各线程各自配置并以CAS安装，
+ * 失败者归还自己配置的空间，不必等待其他线程。
+ * 每个元素带一个就绪标志，构造完成后以release写入。size()从已知的连续就绪前缀向后扫描就绪标志，
+ * 并把结果记回published，因此写者之间互不等待：一个被抢占的写者只会暂时挡住size()的推进，不会阻塞其他写者。
+ * 读者只访问[0, size())，可与写者并发迭代。
+ * 配置器须可由多个线程同时调用，缺省为malloc_alloc（第二级配置器的free list未加锁）。
+ */
+
+namespace mystl {
+
+template <class T, class Alloc = malloc_alloc, size_t base_bits = 5>
+class concurrent_vector {
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef T&          reference;
+    typedef size_t      size_type;
+    typedef ptrdiff_t   difference_type;
+
+    class iterator {
+    public:
+        typedef random_access_iterator_tag  iterator_category;
+        typedef T                           value_type;
+        typedef ptrdiff_t                   difference_type;
+        typedef T*                          pointer;
+        typedef T&                          reference;
+
+        iterator() : v(0), i(0) {}
+        iterator(concurrent_vector *vec, size_type idx) : v(vec), i(idx) {}
+
+        reference operator*() const { return (*v)[i]; }
+        pointer operator->() const { return &(*v)[i]; }
+        reference operator[](difference_type n) const { return (*v)[i + n]; }
+
+        iterator& operator++() { ++i; return *this; }
+        iterator& operator--() { --i; return *this; }
+        iterator operator++(int) { iterator tmp = *this; ++i; return tmp; }
+        iterator operator--(int) { iterator tmp = *this; --i; return tmp; }
+        iterator& operator+=(difference_type n) { i += n; return *this; }
+        iterator& operator-=(difference_type n) { i -= n; return *this; }
+        iterator operator+(difference_type n) const { return iterator(v, i + n); }
+        iterator operator-(difference_type n) const { return iterator(v, i - n); }
+        difference_type operator-(const iterator& x) const { return difference_type(i) - difference_type(x.i); }
+
+        bool operator==(const iterator& x) const { return i == x.i; }
+        bool operator!=(const iterator& x) const { return i != x.i; }
+        bool operator<(const iterator& x) const { return i < x.i; }
+        bool operator>(const iterator& x) const { return i > x.i; }
+        bool operator<=(const iterator& x) const { return i <= x.i; }
+        bool operator>=(const iterator& x) const { return i >= x.i; }
+
+    private:
+        concurrent_vector *v;
+        size_type i;
+    };
+
+protected:
+    // segment的空间按字节配置：前段为元素，后段为各元素的就绪标志
+    typedef mystl::simple_alloc<char, Alloc> data_allocator;
+    typedef std::atomic<unsigned char> ready_flag;
+
+    enum {__MAX_SEGMENTS = 64 - base_bits + 1};
+
+    std::atomic<T*> segments[__MAX_SEGMENTS];
+    std::atomic<size_type> reserved;            // 已预留的元素个数
+    mutable std::atomic<size_type> published;   // 已知全部就绪的前缀长度，只增不减
+
+    static size_type first_segment_size()
+    {
+        return size_type(1) << base_bits;
+    }
+
+    // 下标n所在的segment
+    static size_type segment_index(size_type n)
+    {
+        size_type k = n >> base_bits;
+        return 0 == k ? 0 : 64 - __builtin_clzll(k);
+    }
+
+    // segment k的首个下标
+    static size_type segment_base(size_type k)
+    {
+        return 0 == k ? 0 : first_segment_size() << (k - 1);
+    }
+
+    static size_type segment_size(size_type k)
+    {
+        return 0 == k ? first_segment_size() : first_segment_size() << (k - 1);
+    }
+
+    static size_type segment_bytes(size_type k)
+    {
+        return segment_size(k) * (sizeof(T) + sizeof(ready_flag));
+    }
+
+    static ready_flag *segment_flags(T *s, size_type k)
+    {
+        return (ready_flag *)(s + segment_size(k));
+    }
+
+public:
+    concurrent_vector() : reserved(0), published(0)
+    {
+        for (size_type k = 0; k < __MAX_SEGMENTS; ++k) {
+            segments[k].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // 析构时不得再有并发访问
+    ~concurrent_vector()
+    {
+        clear();
+        for (size_type k = 0; k < __MAX_SEGMENTS; ++k) {
+            T *s = segments[k].load(std::memory_order_relaxed);
+            if (s) {
+                data_allocator::deallocate((char *)s, segment_bytes(k));
+            }
+        }
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+
+    // 连续就绪的元素个数，[0, size())内的元素均可安全读取
+    size_type size() const
+    {
+        size_type n = published.load(std::memory_order_acquire);
+        size_type limit = reserved.load(std::memory_order_acquire);
+        size_type old = n;
+        while (n < limit && ready(n)) {
+            ++n;
+        }
+        // 把扫描结果记回published，只往大的方向推进
+        while (n > old && !published.compare_exchange_weak(old, n, std::memory_order_acq_rel)) {}
+        return n;
+    }
+
+    bool empty() const
+    {
+        return 0 == size();
+    }
+
+    reference operator[](size_type n)
+    {
+        size_type k = segment_index(n);
+        return segments[k].load(std::memory_order_acquire)[n - segment_base(k)];
+    }
+
+    reference front() { return (*this)[0]; }
+    reference back() { return (*this)[size() - 1]; }
+
+    /**
+     * @brief 并发追加一个元素
+     * @return size_type 新元素的下标
+     */
+    size_type push_back(const T& x)
+    {
+        return grow_by(1, x);
+    }
+
+    /**
+     * @brief 并发追加n个值为x的元素
+     * @return size_type 第一个新元素的下标
+     */
+    size_type grow_by(size_type n, const T& x = T())
+    {
+        if (0 == n) {
+            return reserved.load(std::memory_order_relaxed);
+        }
+        size_type first = reserved.fetch_add(n, std::memory_order_relaxed);
+        size_type last = first + n;
+
+        // 省略异常处理：T的拷贝构造不应抛出异常，否则该元素永不就绪，size()停在它之前
+        for (size_type i = first; i < last; ) {
+            size_type k = segment_index(i);
+            T *s = ensure_segment(k);
+            ready_flag *flags = segment_flags(s, k);
+            size_type end = segment_base(k) + segment_size(k);
+            if (end > last) {
+                end = last;
+            }
+            for (; i < end; ++i) {
+                size_type j = i - segment_base(k);
+                mystl::construct(s + j, x);
+                flags[j].store(1, std::memory_order_release);
+            }
+        }
+        return first;
+    }
+
+    // 仅在没有并发写者时调用
+    void clear()
+    {
+        size_type n = reserved.load(std::memory_order_relaxed);
+        for (size_type i = 0; i < n; ++i) {
+            size_type k = segment_index(i);
+            T *s = segments[k].load(std::memory_order_relaxed);
+            ready_flag& flag = segment_flags(s, k)[i - segment_base(k)];
+            if (flag.load(std::memory_order_relaxed)) {
+                mystl::destroy(s + (i - segment_base(k)));
+                flag.store(0, std::memory_order_relaxed);
+            }
+        }
+        reserved.store(0, std::memory_order_relaxed);
+        published.store(0, std::memory_order_release);
+    }
+
+private:
+    concurrent_vector(const concurrent_vector&);
+    concurrent_vector& operator=(const concurrent_vector&);
+
+    // 下标n的元素是否已构造完成
+    bool ready(size_type n) const
+    {
+        size_type k = segment_index(n);
+        T *s = segments[k].load(std::memory_order_acquire);
+        return s && segment_flags(s, k)[n - segment_base(k)].load(std::memory_order_acquire);
+    }
+
+    // 取得segment k；尚未配置时自行配置并以CAS安装，安装失败则归还
+    T *ensure_segment(size_type k)
+    {
+        T *s = segments[k].load(std::memory_order_acquire);
+        if (s) {
+            return s;
+        }
+        T *fresh = (T *)data_allocator::allocate(segment_bytes(k));
+        ready_flag *flags = segment_flags(fresh, k);
+        for (size_type j = 0; j < segment_size(k); ++j) {
+            new (flags + j) ready_flag(0);
+        }
+        if (segments[k].compare_exchange_strong(s, fresh, std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        data_allocator::deallocate((char *)fresh, segment_bytes(k));
+        return s;
+    }
+};
+
+}
+
+#endif
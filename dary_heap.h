@@ -0,0 +1,391 @@
+#ifndef MYSTL_DARY_HEAP_H_
+#define MYSTL_DARY_HEAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include "alloc.h"
+#include "vector.h"
+#include "iterator.h"
+#include "slot_map.h"
+
+/**
+ * @brief d叉堆与优先队列
+ * 二叉堆每下沉一层就跳到一个新的cache line，堆很大时每次pop都有log2(n)次cache miss。
+ * d叉堆把节点i的D个子节点D*i+1 ... D*i+D连续存放，树高降为logD(n)：每层多比较几次，
+ * 但下沉经过的层数（也就是访问的不相邻区段）少得多。下沉时顺便预取下一组子节点。
+ * 兄弟节点组并未对齐到cache line边界，一组可能跨两条cache line。
+ * 与SGI的heap算法一样，以“空洞”下沉/上浮，每层只做一次搬移而非交换。
+ *   make_dary_heap / push_dary_heap / pop_dary_heap：作用于任意随机访问区间；
+ *   dary_heap：以Vector为底层容器的优先队列，支持批量heapify；
+ *   indexed_dary_heap：push返回句柄，可按句柄decrease_key / update / erase。
+ * 与std::priority_queue相同，Compare为less时堆顶是最大元素。
+ */
+
+namespace mystl {
+
+struct __heap_less {
+    template <class T>
+    bool operator()(const T& a, const T& b) const { return a < b; }
+};
+
+// 普通堆不需要记录元素位置
+struct __heap_no_index {
+    template <class T>
+    void operator()(const T&, size_t) const {}
+};
+
+/**
+ * @brief 空洞上浮：把value放进hole，沿父节点向上直到父节点不比它小
+ * index(elem, pos)在每个元素落到新位置时被调用，供indexed_dary_heap维护句柄
+ */
+template <size_t D, class RandomAccessIterator, class T, class Compare, class Index>
+void __dary_sift_up(RandomAccessIterator first, size_t hole, T value,
+                    const Compare& comp, const Index& index)
+{
+    while (hole > 0) {
+        size_t parent = (hole - 1) / D;
+        if (!comp(first[parent], value)) {
+            break;
+        }
+        first[hole] = std::move(first[parent]);
+        index(first[hole], hole);
+        hole = parent;
+    }
+    first[hole] = std::move(value);
+    index(first[hole], hole);
+}
+
+/**
+ * @brief 空洞下沉：在D个子节点中选出最大者，比value大就上移，空洞随之下降
+ */
+template <size_t D, class RandomAccessIterator, class T, class Compare, class Index>
+void __dary_sift_down(RandomAccessIterator first, size_t hole, size_t len, T value,
+                      const Compare& comp, const Index& index)
+{
+    for (;;) {
+        size_t child = D * hole + 1;
+        if (child >= len) {
+            break;
+        }
+        size_t last = len - child > D ? child + D : len;
+        size_t best = child;
+        for (size_t c = child + 1; c < last; ++c) {
+            if (comp(first[best], first[c])) {
+                best = c;
+            }
+        }
+        if (!comp(value, first[best])) {
+            break;
+        }
+        if (D * best + 1 < len) {
+            __builtin_prefetch(&*(first + (D * best + 1))); // 下一层的兄弟节点
+        }
+        first[hole] = std::move(first[best]);
+        index(first[hole], hole);
+        hole = best;
+    }
+    first[hole] = std::move(value);
+    index(first[hole], hole);
+}
+
+// Floyd建堆：自最后一个内部节点起逐个下沉，O(n)
+template <size_t D, class RandomAccessIterator, class Compare, class Index>
+void __make_dary_heap(RandomAccessIterator first, size_t len, const Compare& comp, const Index& index)
+{
+    if (len < 2) {
+        for (size_t i = 0; i < len; ++i) {
+            index(first[i], i);
+        }
+        return;
+    }
+    // 叶子节点不动，只需登记位置
+    size_t parent = (len - 2) / D;
+    for (size_t i = parent + 1; i < len; ++i) {
+        index(first[i], i);
+    }
+    for (;;) {
+        __dary_sift_down<D>(first, parent, len, std::move(first[parent]), comp, index);
+        if (0 == parent) {
+            break;
+        }
+        --parent;
+    }
+}
+
+template <size_t D, class RandomAccessIterator, class Compare>
+inline void make_dary_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+{
+    __make_dary_heap<D>(first, size_t(last - first), comp, __heap_no_index());
+}
+
+template <size_t D, class RandomAccessIterator>
+inline void make_dary_heap(RandomAccessIterator first, RandomAccessIterator last)
+{
+    make_dary_heap<D>(first, last, __heap_less());
+}
+
+// [first, last-1)已是堆，把last-1处的新元素加入
+template <size_t D, class RandomAccessIterator, class Compare>
+inline void push_dary_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+{
+    typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+    size_t hole = size_t(last - first) - 1;
+    T value = std::move(first[hole]);
+    __dary_sift_up<D>(first, hole, std::move(value), comp, __heap_no_index());
+}
+
+template <size_t D, class RandomAccessIterator>
+inline void push_dary_heap(RandomAccessIterator first, RandomAccessIterator last)
+{
+    push_dary_heap<D>(first, last, __heap_less());
+}
+
+// 把堆顶移到last-1，[first, last-1)仍是堆
+template <size_t D, class RandomAccessIterator, class Compare>
+inline void pop_dary_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+{
+    typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+    size_t len = size_t(last - first) - 1;
+    if (0 == len) {
+        return;
+    }
+    T value = std::move(first[len]);
+    first[len] = std::move(first[0]);
+    __dary_sift_down<D>(first, 0, len, std::move(value), comp, __heap_no_index());
+}
+
+template <size_t D, class RandomAccessIterator>
+inline void pop_dary_heap(RandomAccessIterator first, RandomAccessIterator last)
+{
+    pop_dary_heap<D>(first, last, __heap_less());
+}
+
+/**
+ * @brief 以Vector为底层容器的d叉堆优先队列
+ */
+template <class T, size_t D = 4, class Compare = __heap_less, class Alloc = mystl::alloc>
+class dary_heap {
+    static_assert(D >= 2, "dary_heap needs at least 2 children per node");
+public:
+    typedef T               value_type;
+    typedef const T&        const_reference;
+    typedef size_t          size_type;
+    typedef Compare         value_compare;
+
+protected:
+    Vector<T, Alloc> c;     // 底层容器
+    Compare comp;
+
+public:
+    dary_heap() {}
+    explicit dary_heap(const Compare& x) : comp(x) {}
+
+    template <class InputIterator>
+    dary_heap(InputIterator first, InputIterator last, const Compare& x = Compare()) : comp(x)
+    {
+        heapify(first, last);
+    }
+
+    bool empty() const { return c.empty(); }
+    size_type size() const { return c.size(); }
+    const_reference top() const { return c[0]; }
+
+    void reserve(size_type n) { c.reserve(n); }
+    void clear() { c.clear(); }
+
+    void push(const T& x)
+    {
+        c.push_back(x);
+        push_dary_heap<D>(c.begin(), c.end(), comp);
+    }
+
+    void pop()
+    {
+        T value = std::move(c.back());
+        c.pop_back();
+        if (!c.empty()) {
+            __dary_sift_down<D>(c.begin(), 0, c.size(), std::move(value), comp, __heap_no_index());
+        }
+    }
+
+    // 以[first, last)取代现有内容并一次建堆，比逐个push快：O(n)而非O(n log n)
+    template <class InputIterator>
+    void heapify(InputIterator first, InputIterator last)
+    {
+        c.clear();
+        append(first, last);
+    }
+
+    // 批量加入[first, last)后重新建堆
+    template <class InputIterator>
+    void append(InputIterator first, InputIterator last)
+    {
+        for (; first != last; ++first) {
+            c.push_back(*first);
+        }
+        make_dary_heap<D>(c.begin(), c.end(), comp);
+    }
+
+    void swap(dary_heap& x)
+    {
+        c.swap(x.c);
+        std::swap(comp, x.comp);
+    }
+};
+
+/**
+ * @brief 可按句柄修改的d叉堆
+ * 句柄沿用slot_map的slot_handle(index, generation)，格表也与slot_map共用__slot_table：
+ * 每格记录句柄所指元素在堆中的位置，元素每次搬移都更新该格；删除后世代号加一，旧句柄失效，
+ * 空出的格供之后的push复用。decrease_key()/update()/erase()遇到失效的句柄时什么也不做，返回false。
+ */
+template <class T, size_t D = 4, class Compare = __heap_less, class Alloc = mystl::alloc>
+class indexed_dary_heap {
+    static_assert(D >= 2, "indexed_dary_heap needs at least 2 children per node");
+public:
+    typedef T               value_type;
+    typedef const T&        const_reference;
+    typedef size_t          size_type;
+    typedef Compare         value_compare;
+    typedef slot_handle     handle;
+
+protected:
+    struct node {
+        T value;
+        uint32_t slot;
+    };
+
+    typedef typename __slot_table<Alloc>::slot slot;
+
+    struct node_compare {
+        Compare comp;
+        node_compare(const Compare& x) : comp(x) {}
+        bool operator()(const node& a, const node& b) const { return comp(a.value, b.value); }
+    };
+
+    // 元素落到新位置时更新所属格
+    struct node_index {
+        slot *slots;
+        node_index(slot *s) : slots(s) {}
+        void operator()(const node& n, size_t pos) const { slots[n.slot].pos = uint32_t(pos); }
+    };
+
+    Vector<node, Alloc> heap;
+    __slot_table<Alloc> slots;
+    node_compare comp;
+
+public:
+    indexed_dary_heap(const Compare& x = Compare()) : comp(x) {}
+
+    bool empty() const { return heap.empty(); }
+    size_type size() const { return heap.size(); }
+    const_reference top() const { return heap[0].value; }
+
+    handle top_handle() const
+    {
+        return slots.handle_of(heap[0].slot);
+    }
+
+    void reserve(size_type n)
+    {
+        heap.reserve(n);
+        slots.reserve(n);
+    }
+
+    bool contains(handle h) const
+    {
+        return slots.contains(h);
+    }
+
+    // 不检查句柄
+    const_reference get(handle h) const
+    {
+        return heap[slots.pos(h.index)].value;
+    }
+
+    handle push(const T& x)
+    {
+        uint32_t s = slots.acquire();
+        node n = { x, s };
+        heap.push_back(n);
+        __dary_sift_up<D>(heap.begin(), heap.size() - 1, std::move(heap.back()), comp, node_index(slots.data()));
+        return slots.handle_of(s);
+    }
+
+    void pop()
+    {
+        remove_at(0);
+    }
+
+    // 把h所指元素改为x，x的优先级不得低于原值（Compare为less时即x不小于原值），只需上浮
+    // 句柄无效时返回false
+    bool decrease_key(handle h, const T& x)
+    {
+        if (!contains(h)) {
+            return false;
+        }
+        size_t pos = slots.pos(h.index);
+        node n = { x, h.index };
+        __dary_sift_up<D>(heap.begin(), pos, std::move(n), comp, node_index(slots.data()));
+        return true;
+    }
+
+    // 把h所指元素改为任意值，视情况上浮或下沉；句柄无效时返回false
+    bool update(handle h, const T& x)
+    {
+        if (!contains(h)) {
+            return false;
+        }
+        size_t pos = slots.pos(h.index);
+        node n = { x, h.index };
+        reposition(pos, std::move(n));
+        return true;
+    }
+
+    // 删除句柄所指的元素，句柄无效时返回false
+    bool erase(handle h)
+    {
+        if (!contains(h)) {
+            return false;
+        }
+        remove_at(slots.pos(h.index));
+        return true;
+    }
+
+    // 删除所有元素，所有句柄都失效
+    void clear()
+    {
+        for (size_type i = 0; i < heap.size(); ++i) {
+            slots.release(heap[i].slot);
+        }
+        heap.clear();
+    }
+
+private:
+    // 以n取代pos处的元素
+    void reposition(size_t pos, node n)
+    {
+        node_index index(slots.data());
+        if (pos > 0 && comp(heap[(pos - 1) / D], n)) {
+            __dary_sift_up<D>(heap.begin(), pos, std::move(n), comp, index);
+        } else {
+            __dary_sift_down<D>(heap.begin(), pos, heap.size(), std::move(n), comp, index);
+        }
+    }
+
+    // 删除pos处的元素：以最后一个元素填补，再上浮或下沉
+    void remove_at(size_t pos)
+    {
+        slots.release(heap[pos].slot);
+        node last = std::move(heap.back());
+        heap.pop_back();
+        if (pos < heap.size()) {
+            reposition(pos, std::move(last));
+        }
+    }
+};
+
+}
+
+#endif
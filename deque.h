@@ -0,0 +1,505 @@
+#ifndef MYSTL_DEQUE_H_
+#define MYSTL_DEQUE_H_
+
+#include <stddef.h>
+#include <algorithm>
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+
+/**
+ * @brief 分段连续的双端队列（仿SGI deque）
+ * 元素存放在若干固定大小的缓冲区中，map是一段连续的指针数组，每个指针指向一个缓冲区。
+ * 在两端插入/删除都是O(1)，且不会搬动已有元素，元素地址在两端操作下保持不变；
+ * 空间不足时只重新配置map（指针数组），缓冲区本身从不复制。
+ * 缓冲区大小由__deque_buf_size依sizeof(T)决定；map与缓冲区都由Alloc（缺省为第二级配置器）配置。
+ * 两端交替地用尽、释放缓冲区时（典型的队列用法），释放的缓冲区先放进一个小的备用缓存，
+ * 下次需要新缓冲区时直接取用，避免反复向配置器申请与归还。
+ */
+
+namespace mystl {
+
+/**
+ * @brief 一个缓冲区容纳的元素个数
+ * 元素不大于256字节时缓冲区取一页（4096字节），否则固定容纳16个元素
+ */
+inline size_t __deque_buf_size(size_t sz)
+{
+    return sz <= 256 ? 4096 / sz : size_t(16);
+}
+
+enum {__DEQUE_SPARE = 4};         // 备用缓冲区的个数上限
+enum {__DEQUE_INITIAL_MAP = 8};   // map最少管理的节点数
+
+template <class T, class Ref, class Ptr>
+struct __deque_iterator {
+    typedef __deque_iterator<T, T&, T*>             iterator;
+    typedef __deque_iterator<T, const T&, const T*> const_iterator;
+    typedef __deque_iterator                        self;
+
+    typedef random_access_iterator_tag  iterator_category;
+    typedef T                           value_type;
+    typedef Ptr                         pointer;
+    typedef Ref                         reference;
+    typedef size_t                      size_type;
+    typedef ptrdiff_t                   difference_type;
+    typedef T**                         map_pointer;
+
+    T *cur;             // 此迭代器所指缓冲区中的当前元素
+    T *first;           // 此迭代器所指缓冲区的头
+    T *last;            // 此迭代器所指缓冲区的尾（含备用空间）
+    map_pointer node;   // 指向map中对应的节点
+
+    static size_t buffer_size() { return __deque_buf_size(sizeof(T)); }
+
+    __deque_iterator() : cur(0), first(0), last(0), node(0) {}
+    __deque_iterator(T *x, map_pointer y) : cur(x), first(*y), last(*y + buffer_size()), node(y) {}
+    __deque_iterator(const iterator& x) : cur(x.cur), first(x.first), last(x.last), node(x.node) {}
+    __deque_iterator& operator=(const __deque_iterator&) = default;
+
+    // 跳到另一个缓冲区
+    void set_node(map_pointer new_node)
+    {
+        node = new_node;
+        first = *new_node;
+        last = first + difference_type(buffer_size());
+    }
+
+    reference operator*() const { return *cur; }
+    pointer operator->() const { return cur; }
+
+    difference_type operator-(const self& x) const
+    {
+        return difference_type(buffer_size()) * (node - x.node - 1) + (cur - first) + (x.last - x.cur);
+    }
+
+    self& operator++()
+    {
+        ++cur;
+        if (cur == last) {
+            set_node(node + 1);
+            cur = first;
+        }
+        return *this;
+    }
+
+    self operator++(int) { self tmp = *this; ++*this; return tmp; }
+
+    self& operator--()
+    {
+        if (cur == first) {
+            set_node(node - 1);
+            cur = last;
+        }
+        --cur;
+        return *this;
+    }
+
+    self operator--(int) { self tmp = *this; --*this; return tmp; }
+
+    self& operator+=(difference_type n)
+    {
+        difference_type offset = n + (cur - first);
+        if (offset >= 0 && offset < difference_type(buffer_size())) {
+            cur += n; // 目标位置在同一缓冲区内
+        } else {
+            difference_type node_offset = offset > 0 ? offset / difference_type(buffer_size())
+                : -difference_type((-offset - 1) / buffer_size()) - 1;
+            set_node(node + node_offset);
+            cur = first + (offset - node_offset * difference_type(buffer_size()));
+        }
+        return *this;
+    }
+
+    self operator+(difference_type n) const { self tmp = *this; return tmp += n; }
+    self& operator-=(difference_type n) { return *this += -n; }
+    self operator-(difference_type n) const { self tmp = *this; return tmp -= n; }
+
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    bool operator==(const self& x) const { return cur == x.cur; }
+    bool operator!=(const self& x) const { return !(*this == x); }
+    bool operator<(const self& x) const { return node == x.node ? cur < x.cur : node < x.node; }
+    bool operator>(const self& x) const { return x < *this; }
+    bool operator<=(const self& x) const { return !(x < *this); }
+    bool operator>=(const self& x) const { return !(*this < x); }
+};
+
+template <class T, class Ref, class Ptr>
+inline __deque_iterator<T, Ref, Ptr> operator+(ptrdiff_t n, const __deque_iterator<T, Ref, Ptr>& x)
+{
+    return x + n;
+}
+
+template <class T, class Alloc = mystl::alloc>
+class Deque {
+public:
+    typedef T                   value_type;
+    typedef value_type*         pointer;
+    typedef value_type&         reference;
+    typedef const value_type&   const_reference;
+    typedef size_t              size_type;
+    typedef ptrdiff_t           difference_type;
+
+    typedef __deque_iterator<T, T&, T*>             iterator;
+    typedef __deque_iterator<T, const T&, const T*> const_iterator;
+
+protected:
+    typedef pointer* map_pointer;
+    // 以下，simple_alloc是SGI STL的空间配置器
+    typedef simple_alloc<value_type, Alloc> data_allocator;   // 每次配置一个元素大小
+    typedef simple_alloc<pointer, Alloc> map_allocator;       // 每次配置一个指针大小
+
+    iterator start;             // 第一个元素
+    iterator finish;            // 最后一个元素的下一位置
+    map_pointer map;            // 指向map，map中的每个元素指向一个缓冲区
+    size_type map_size;         // map内可容纳多少指针
+    pointer spare[__DEQUE_SPARE];   // 备用缓冲区
+    size_type nspare;
+
+    static size_type buffer_size() { return __deque_buf_size(sizeof(T)); }
+
+public:
+    Deque() : map(0), map_size(0), spare(), nspare(0)
+    {
+        create_map_and_nodes(0);
+    }
+
+    Deque(size_type n, const T& value) : map(0), map_size(0), spare(), nspare(0)
+    {
+        create_map_and_nodes(n);
+        for (iterator cur = start; cur != finish; ++cur) {
+            mystl::construct(cur.cur, value);
+        }
+    }
+
+    Deque(const Deque& x) : map(0), map_size(0), spare(), nspare(0)
+    {
+        create_map_and_nodes(x.size());
+        iterator cur = start;
+        for (const_iterator p = x.begin(); p != x.end(); ++p, ++cur) {
+            mystl::construct(cur.cur, *p);
+        }
+    }
+
+    Deque& operator=(const Deque& x)
+    {
+        if (this != &x) {
+            clear();
+            for (const_iterator p = x.begin(); p != x.end(); ++p) {
+                push_back(*p);
+            }
+        }
+        return *this;
+    }
+
+    ~Deque()
+    {
+        destroy_range(start, finish);
+        destroy_nodes(start.node, finish.node + 1);
+        release_spare();
+        map_allocator::deallocate(map, map_size);
+    }
+
+    iterator begin() { return start; }
+    iterator end() { return finish; }
+    const_iterator begin() const { return start; }
+    const_iterator end() const { return finish; }
+
+    reference operator[](size_type n) { return start[difference_type(n)]; }
+    const_reference operator[](size_type n) const { return start[difference_type(n)]; }
+
+    reference front() { return *start; }
+    reference back() { iterator tmp = finish; --tmp; return *tmp; }
+    const_reference front() const { return *start; }
+    const_reference back() const { const_iterator tmp = finish; --tmp; return *tmp; }
+
+    size_type size() const { return size_type(finish - start); }
+    bool empty() const { return finish == start; }
+
+    void push_back(const T& x)
+    {
+        if (finish.cur != finish.last - 1) {
+            mystl::construct(finish.cur, x); // 缓冲区尚有两个以上的空间
+            ++finish.cur;
+        } else {
+            push_back_aux(x);
+        }
+    }
+
+    void push_front(const T& x)
+    {
+        if (start.cur != start.first) {
+            mystl::construct(start.cur - 1, x);
+            --start.cur;
+        } else {
+            push_front_aux(x);
+        }
+    }
+
+    void pop_back()
+    {
+        if (finish.cur != finish.first) {
+            --finish.cur;
+            mystl::destroy(finish.cur);
+        } else {
+            // 最后一个缓冲区没有元素，释放它
+            deallocate_node(finish.first);
+            finish.set_node(finish.node - 1);
+            finish.cur = finish.last - 1;
+            mystl::destroy(finish.cur);
+        }
+    }
+
+    void pop_front()
+    {
+        if (start.cur != start.last - 1) {
+            mystl::destroy(start.cur);
+            ++start.cur;
+        } else {
+            // 第一个缓冲区只剩一个元素，析构后释放该缓冲区
+            mystl::destroy(start.cur);
+            deallocate_node(start.first);
+            start.set_node(start.node + 1);
+            start.cur = start.first;
+        }
+    }
+
+    // 清除所有元素，只保留一个缓冲区，其余缓冲区进入备用缓存或归还配置器
+    void clear()
+    {
+        destroy_range(start, finish);
+        destroy_nodes(start.node + 1, finish.node + 1);
+        finish = start;
+    }
+
+    // 在position之前插入x，搬动离position较近的一端
+    iterator insert(iterator position, const T& x)
+    {
+        if (position.cur == start.cur) {
+            push_front(x);
+            return start;
+        } else if (position.cur == finish.cur) {
+            push_back(x);
+            iterator tmp = finish;
+            --tmp;
+            return tmp;
+        }
+        return insert_aux(position, x);
+    }
+
+    iterator erase(iterator position)
+    {
+        iterator next = position;
+        ++next;
+        difference_type index = position - start;
+        if (size_type(index) < (size() >> 1)) {
+            std::copy_backward(start, position, next); // 前方元素较少，前方后移
+            pop_front();
+        } else {
+            std::copy(next, finish, position); // 后方元素较少，后方前移
+            pop_back();
+        }
+        return start + index;
+    }
+
+    iterator erase(iterator first, iterator last)
+    {
+        if (first == start && last == finish) {
+            clear();
+            return finish;
+        }
+        difference_type n = last - first;
+        difference_type elems_before = first - start;
+        if (elems_before < difference_type(size() - n) / 2) {
+            std::copy_backward(start, first, last); // 前方元素较少
+            iterator new_start = start + n;
+            destroy_range(start, new_start);
+            destroy_nodes(start.node, new_start.node);
+            start = new_start;
+        } else {
+            std::copy(last, finish, first); // 后方元素较少
+            iterator new_finish = finish - n;
+            destroy_range(new_finish, finish);
+            destroy_nodes(new_finish.node + 1, finish.node + 1);
+            finish = new_finish;
+        }
+        return start + elems_before;
+    }
+
+    void swap(Deque& x)
+    {
+        std::swap(start, x.start);
+        std::swap(finish, x.finish);
+        std::swap(map, x.map);
+        std::swap(map_size, x.map_size);
+        size_type n = std::max(nspare, x.nspare);
+        std::swap(nspare, x.nspare);
+        for (size_type i = 0; i < n; ++i) {
+            std::swap(spare[i], x.spare[i]);
+        }
+    }
+
+    // 归还备用缓存中的缓冲区
+    void shrink_to_fit()
+    {
+        release_spare();
+    }
+
+protected:
+    pointer allocate_node()
+    {
+        if (nspare > 0) {
+            return spare[--nspare];
+        }
+        return data_allocator::allocate(buffer_size());
+    }
+
+    void deallocate_node(pointer p)
+    {
+        if (nspare < __DEQUE_SPARE) {
+            spare[nspare++] = p;
+        } else {
+            data_allocator::deallocate(p, buffer_size());
+        }
+    }
+
+    void release_spare()
+    {
+        while (nspare > 0) {
+            data_allocator::deallocate(spare[--nspare], buffer_size());
+        }
+    }
+
+    void destroy_range(iterator first, iterator last)
+    {
+        for (; first != last; ++first) {
+            mystl::destroy(first.cur);
+        }
+    }
+
+    void destroy_nodes(map_pointer nstart, map_pointer nfinish)
+    {
+        for (map_pointer cur = nstart; cur < nfinish; ++cur) {
+            deallocate_node(*cur);
+        }
+    }
+
+    // 配置map及容纳num_elements个元素所需的缓冲区，元素本身尚未构造
+    void create_map_and_nodes(size_type num_elements)
+    {
+        size_type num_nodes = num_elements / buffer_size() + 1;
+        // 前后各预留一个节点，扩充时可用
+        map_size = std::max(size_type(__DEQUE_INITIAL_MAP), num_nodes + 2);
+        map = map_allocator::allocate(map_size);
+
+        // 令nstart和nfinish指向map的中段，使两端的扩充空间一样大
+        map_pointer nstart = map + (map_size - num_nodes) / 2;
+        map_pointer nfinish = nstart + num_nodes - 1;
+        for (map_pointer cur = nstart; cur <= nfinish; ++cur) {
+            *cur = allocate_node(); // 省略异常处理
+        }
+        start.set_node(nstart);
+        finish.set_node(nfinish);
+        start.cur = start.first;
+        finish.cur = finish.first + num_elements % buffer_size();
+    }
+
+    // 最后一个缓冲区只剩一个空间时才会调用
+    void push_back_aux(const T& x)
+    {
+        T x_copy = x; // x可能是自身的元素，重新配置map前先复制
+        reserve_map_at_back();
+        *(finish.node + 1) = allocate_node();
+        mystl::construct(finish.cur, x_copy);
+        finish.set_node(finish.node + 1);
+        finish.cur = finish.first;
+    }
+
+    // 第一个缓冲区没有空间时才会调用
+    void push_front_aux(const T& x)
+    {
+        T x_copy = x;
+        reserve_map_at_front();
+        *(start.node - 1) = allocate_node();
+        start.set_node(start.node - 1);
+        start.cur = start.last - 1;
+        mystl::construct(start.cur, x_copy);
+    }
+
+    void reserve_map_at_back(size_type nodes_to_add = 1)
+    {
+        if (nodes_to_add + 1 > map_size - (finish.node - map)) {
+            reallocate_map(nodes_to_add, false); // map尾端的节点备用空间不足
+        }
+    }
+
+    void reserve_map_at_front(size_type nodes_to_add = 1)
+    {
+        if (nodes_to_add > size_type(start.node - map)) {
+            reallocate_map(nodes_to_add, true); // map前端的节点备用空间不足
+        }
+    }
+
+    /**
+     * @brief 重新安排map
+     * map的空间足够大时只把使用中的节点移到中段，否则配置一块更大的map；缓冲区本身不动
+     */
+    void reallocate_map(size_type nodes_to_add, bool add_at_front)
+    {
+        size_type old_num_nodes = finish.node - start.node + 1;
+        size_type new_num_nodes = old_num_nodes + nodes_to_add;
+
+        map_pointer new_nstart;
+        if (map_size > 2 * new_num_nodes) {
+            new_nstart = map + (map_size - new_num_nodes) / 2 + (add_at_front ? nodes_to_add : 0);
+            if (new_nstart < start.node) {
+                std::copy(start.node, finish.node + 1, new_nstart);
+            } else {
+                std::copy_backward(start.node, finish.node + 1, new_nstart + old_num_nodes);
+            }
+        } else {
+            size_type new_map_size = map_size + std::max(map_size, nodes_to_add) + 2;
+            map_pointer new_map = map_allocator::allocate(new_map_size);
+            new_nstart = new_map + (new_map_size - new_num_nodes) / 2 + (add_at_front ? nodes_to_add : 0);
+            std::copy(start.node, finish.node + 1, new_nstart);
+            map_allocator::deallocate(map, map_size);
+            map = new_map;
+            map_size = new_map_size;
+        }
+
+        start.set_node(new_nstart);
+        finish.set_node(new_nstart + old_num_nodes - 1);
+    }
+
+    iterator insert_aux(iterator pos, const T& x)
+    {
+        difference_type index = pos - start; // 插入点之前的元素个数
+        T x_copy = x;
+        if (size_type(index) < size() / 2) {
+            push_front(front()); // 前方元素较少，在最前端加入与第一个元素同值的元素
+            iterator front1 = start;
+            ++front1;
+            iterator front2 = front1;
+            ++front2;
+            pos = start + index;
+            iterator pos1 = pos;
+            ++pos1;
+            std::copy(front2, pos1, front1); // 元素前移
+        } else {
+            push_back(back()); // 后方元素较少
+            iterator back1 = finish;
+            --back1;
+            iterator back2 = back1;
+            --back2;
+            pos = start + index;
+            std::copy_backward(pos, back2, back1); // 元素后移
+        }
+        *pos = x_copy;
+        return pos;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,509 @@
+#ifndef MYSTL_FLAT_MAP_H_
+#define MYSTL_FLAT_MAP_H_
+
+#include <stddef.h>
+#include <algorithm>
+#include <utility>
+#include "alloc.h"
+#include "iterator.h"
+#include "vector.h"
+
+/**
+ * @brief 有序的flat_set / flat_map
+ * 元素按键排序后连续存放在Vector中，没有节点，查找是对连续空间的二分查找。
+ * flat_map把键和值分成两个Vector存放，查找时只读键，每条cache line装下更多的键。
+ * 二分查找写成无分支形式（每一步只用比较结果选择下一个起点），免去分支预测失败；
+ * 对读多写少的表，还可以调用build_index()建立Eytzinger（BFS次序）布局的副本，
+ * 查找路径上相邻几层的节点落在同一条cache line上。任何修改都会丢弃该索引。
+ * 批量构造/插入先排序、一遍去重，再与原有元素从尾端向前归并，不再一个一个地搬移。
+ */
+
+namespace mystl {
+
+struct __flat_less {
+    template <class T>
+    bool operator()(const T& a, const T& b) const { return a < b; }
+};
+
+// 无分支的lower_bound：在base[0, n)中寻找第一个不小于k的位置
+template <class Key, class Compare>
+inline const Key *__flat_lower_bound(const Key *base, size_t n, const Key& k, const Compare& comp)
+{
+    if (0 == n) {
+        return base;
+    }
+    while (n > 1) {
+        size_t half = n / 2;
+        base = comp(base[half], k) ? base + half : base;
+        n -= half;
+    }
+    return base + comp(*base, k);
+}
+
+/**
+ * @brief Eytzinger布局的查找索引
+ * keys[1..n]按完全二叉树的BFS次序存放有序序列，rank[i]为keys[i]在有序序列中的下标
+ */
+template <class Key, class Alloc>
+class __eytzinger_index {
+public:
+    __eytzinger_index() : n(0) {}
+
+    bool empty() const
+    {
+        return 0 == n && keys.empty();
+    }
+
+    void clear()
+    {
+        keys.clear();
+        ranks.clear();
+        n = 0;
+    }
+
+    void build(const Key *sorted, size_t len)
+    {
+        clear();
+        n = len;
+        if (0 == n) {
+            return;
+        }
+        keys.reserve(n + 1);
+        ranks.reserve(n + 1);
+        for (size_t i = 0; i <= n; ++i) {
+            keys.push_back(sorted[0]);
+            ranks.push_back(0);
+        }
+        size_t i = 0;
+        fill(sorted, i, 1);
+    }
+
+    // 返回第一个不小于k的元素在有序序列中的下标，不存在时返回n
+    template <class Compare>
+    size_t lower_bound(const Key& k, const Compare& comp) const
+    {
+        size_t i = 1;
+        while (i <= n) {
+            if (16 * i <= n) {
+                __builtin_prefetch(&keys[16 * i]); // 提前取4层之后的节点，不越过末尾
+            }
+            i = 2 * i + comp(keys[i], k);
+        }
+        i >>= __builtin_ffsl(~i);
+        return 0 == i ? n : ranks[i];
+    }
+
+private:
+    Vector<Key, Alloc> keys;
+    Vector<size_t, Alloc> ranks;
+    size_t n;
+
+    // 中序遍历完全二叉树，依次填入有序序列
+    void fill(const Key *sorted, size_t& i, size_t k)
+    {
+        if (k <= n) {
+            fill(sorted, i, 2 * k);
+            keys[k] = sorted[i];
+            ranks[k] = i;
+            ++i;
+            fill(sorted, i, 2 * k + 1);
+        }
+    }
+};
+
+// 将v排序并去除键重复的元素（保留先出现的一个），key(x)取出元素的键
+template <class T, class Alloc, class KeyOf, class Compare>
+void __flat_sort_unique(Vector<T, Alloc>& v, KeyOf key, const Compare& comp)
+{
+    std::stable_sort(v.begin(), v.end(), [&](const T& a, const T& b) { return comp(key(a), key(b)); });
+    size_t w = 0;
+    size_t n = v.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (0 == w || comp(key(v[w - 1]), key(v[i]))) {
+            if (w != i) {
+                v[w] = v[i];
+            }
+            ++w;
+        }
+    }
+    v.erase(v.begin() + w, v.end());
+}
+
+template <class Key, class Compare = __flat_less, class Alloc = mystl::alloc>
+class flat_set {
+public:
+    typedef Key             key_type;
+    typedef Key             value_type;
+    typedef Compare         key_compare;
+    typedef const Key*      iterator;
+    typedef const Key*      const_iterator;
+    typedef size_t          size_type;
+    typedef ptrdiff_t       difference_type;
+
+protected:
+    Vector<Key, Alloc> keys;
+    Compare comp;
+    __eytzinger_index<Key, Alloc> index;
+
+public:
+    flat_set() {}
+
+    // 由未排序的区间批量构造：排序 + 一遍去重
+    template <class InputIterator>
+    flat_set(InputIterator first, InputIterator last)
+    {
+        insert(first, last);
+    }
+
+    iterator begin() const { return keys.begin(); }
+    iterator end() const { return keys.end(); }
+    size_type size() const { return keys.size(); }
+    bool empty() const { return keys.empty(); }
+
+    void reserve(size_type n)
+    {
+        keys.reserve(n);
+    }
+
+    void clear()
+    {
+        index.clear();
+        keys.clear();
+    }
+
+    iterator lower_bound(const Key& k) const
+    {
+        if (!index.empty()) {
+            return begin() + index.lower_bound(k, comp);
+        }
+        return __flat_lower_bound(begin(), size(), k, comp);
+    }
+
+    iterator find(const Key& k) const
+    {
+        iterator it = lower_bound(k);
+        return (it != end() && !comp(k, *it)) ? it : end();
+    }
+
+    size_type count(const Key& k) const
+    {
+        return find(k) == end() ? 0 : 1;
+    }
+
+    // 为当前内容建立Eytzinger索引，之后的查找改走索引
+    void build_index()
+    {
+        index.build(begin(), size());
+    }
+
+    // 单个插入需要搬移插入点之后的元素，大量插入请用区间版本
+    std::pair<iterator, bool> insert(const Key& k)
+    {
+        size_type pos = lower_bound(k) - begin();
+        if (pos != size() && !comp(k, keys[pos])) {
+            return std::pair<iterator, bool>(begin() + pos, false);
+        }
+        index.clear();
+        Key tmp = k;
+        keys.push_back(tmp);
+        for (size_type i = size() - 1; i > pos; --i) {
+            keys[i] = keys[i - 1];
+        }
+        keys[pos] = tmp;
+        return std::pair<iterator, bool>(begin() + pos, true);
+    }
+
+    /**
+     * @brief 批量插入
+     * 新元素先排序去重，剔除已存在的键，再把原有元素与新元素从尾端向前归并，每个元素只移动一次
+     */
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        Vector<Key, Alloc> batch;
+        for (; first != last; ++first) {
+            batch.push_back(*first);
+        }
+        if (batch.empty()) {
+            return;
+        }
+        index.clear();
+        __flat_sort_unique(batch, [](const Key& x) -> const Key& { return x; }, comp);
+
+        size_type m = 0;
+        for (size_type j = 0; j < batch.size(); ++j) {
+            if (count(batch[j]) == 0) {
+                if (m != j) {
+                    batch[m] = batch[j];
+                }
+                ++m;
+            }
+        }
+        if (0 == m) {
+            return;
+        }
+
+        size_type n = size();
+        keys.reserve(n + m);
+        for (size_type j = 0; j < m; ++j) {
+            keys.push_back(batch[0]);
+        }
+        size_type i = n;
+        size_type k = n + m;
+        while (m > 0) {
+            if (i > 0 && comp(batch[m - 1], keys[i - 1])) {
+                keys[--k] = keys[--i];
+            } else {
+                keys[--k] = batch[--m];
+            }
+        }
+    }
+
+    size_type erase(const Key& k)
+    {
+        iterator it = find(k);
+        if (it == end()) {
+            return 0;
+        }
+        index.clear();
+        size_type n = size();
+        for (size_type i = it - begin(); i + 1 < n; ++i) {
+            keys[i] = keys[i + 1];
+        }
+        keys.pop_back();
+        return 1;
+    }
+};
+
+template <class Key, class T, class Compare = __flat_less, class Alloc = mystl::alloc>
+class flat_map {
+public:
+    typedef Key                             key_type;
+    typedef T                               mapped_type;
+    typedef std::pair<Key, T>               value_type;
+    typedef std::pair<const Key&, T&>       reference;  // 代理引用：键与值分开存放
+    typedef Compare                         key_compare;
+    typedef size_t                          size_type;
+    typedef ptrdiff_t                       difference_type;
+
+    class iterator {
+    public:
+        typedef random_access_iterator_tag          iterator_category;
+        typedef typename flat_map::value_type       value_type;
+        typedef ptrdiff_t                           difference_type;
+        typedef void                                pointer;
+        typedef typename flat_map::reference        reference;
+
+        iterator() : m(0), i(0) {}
+        iterator(flat_map *map, size_type idx) : m(map), i(idx) {}
+
+        reference operator*() const { return reference(m->keys[i], m->values[i]); }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        const Key& key() const { return m->keys[i]; }
+        T& value() const { return m->values[i]; }
+
+        iterator& operator++() { ++i; return *this; }
+        iterator& operator--() { --i; return *this; }
+        iterator operator++(int) { iterator tmp = *this; ++i; return tmp; }
+        iterator operator--(int) { iterator tmp = *this; --i; return tmp; }
+        iterator& operator+=(difference_type n) { i += n; return *this; }
+        iterator& operator-=(difference_type n) { i -= n; return *this; }
+        iterator operator+(difference_type n) const { return iterator(m, i + n); }
+        iterator operator-(difference_type n) const { return iterator(m, i - n); }
+        difference_type operator-(const iterator& x) const { return difference_type(i) - difference_type(x.i); }
+
+        bool operator==(const iterator& x) const { return i == x.i; }
+        bool operator!=(const iterator& x) const { return i != x.i; }
+        bool operator<(const iterator& x) const { return i < x.i; }
+
+    private:
+        flat_map *m;
+        size_type i;
+    };
+
+protected:
+    Vector<Key, Alloc> keys;
+    Vector<T, Alloc> values;
+    Compare comp;
+    __eytzinger_index<Key, Alloc> index;
+
+    size_type lower_bound_index(const Key& k) const
+    {
+        if (!index.empty()) {
+            return index.lower_bound(k, comp);
+        }
+        return __flat_lower_bound(keys.begin(), keys.size(), k, comp) - keys.begin();
+    }
+
+    size_type find_index(const Key& k) const
+    {
+        size_type pos = lower_bound_index(k);
+        return (pos != size() && !comp(k, keys[pos])) ? pos : size();
+    }
+
+    // 在pos处插入，搬移其后的键和值
+    void insert_at(size_type pos, const Key& k, const T& x)
+    {
+        index.clear();
+        Key tk = k;
+        T tx = x;
+        keys.push_back(tk);
+        values.push_back(tx);
+        for (size_type i = size() - 1; i > pos; --i) {
+            keys[i] = keys[i - 1];
+            values[i] = values[i - 1];
+        }
+        keys[pos] = tk;
+        values[pos] = tx;
+    }
+
+public:
+    flat_map() {}
+
+    // 由未排序的(key, value)区间批量构造，重复的键保留先出现的一个
+    template <class InputIterator>
+    flat_map(InputIterator first, InputIterator last)
+    {
+        insert(first, last);
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    size_type size() const { return keys.size(); }
+    bool empty() const { return keys.empty(); }
+
+    // 键与值各自的连续空间
+    const Key *key_data() const { return keys.begin(); }
+    T *value_data() { return values.begin(); }
+
+    void reserve(size_type n)
+    {
+        keys.reserve(n);
+        values.reserve(n);
+    }
+
+    void clear()
+    {
+        index.clear();
+        keys.clear();
+        values.clear();
+    }
+
+    void build_index()
+    {
+        index.build(keys.begin(), keys.size());
+    }
+
+    iterator lower_bound(const Key& k)
+    {
+        return iterator(this, lower_bound_index(k));
+    }
+
+    iterator find(const Key& k)
+    {
+        return iterator(this, find_index(k));
+    }
+
+    size_type count(const Key& k) const
+    {
+        return find_index(k) == size() ? 0 : 1;
+    }
+
+    T& operator[](const Key& k)
+    {
+        size_type pos = lower_bound_index(k);
+        if (pos == size() || comp(k, keys[pos])) {
+            insert_at(pos, k, T());
+        }
+        return values[pos];
+    }
+
+    std::pair<iterator, bool> insert(const Key& k, const T& x)
+    {
+        size_type pos = lower_bound_index(k);
+        if (pos != size() && !comp(k, keys[pos])) {
+            return std::pair<iterator, bool>(iterator(this, pos), false);
+        }
+        insert_at(pos, k, x);
+        return std::pair<iterator, bool>(iterator(this, pos), true);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& x)
+    {
+        return insert(x.first, x.second);
+    }
+
+    /**
+     * @brief 批量插入(key, value)
+     * 与flat_set::insert(first, last)相同：排序去重、剔除已有的键，再从尾端向前归并两列
+     */
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last)
+    {
+        Vector<value_type, Alloc> batch;
+        for (; first != last; ++first) {
+            batch.push_back(value_type((*first).first, (*first).second));
+        }
+        if (batch.empty()) {
+            return;
+        }
+        index.clear();
+        __flat_sort_unique(batch, [](const value_type& x) -> const Key& { return x.first; }, comp);
+
+        size_type m = 0;
+        for (size_type j = 0; j < batch.size(); ++j) {
+            if (count(batch[j].first) == 0) {
+                if (m != j) {
+                    batch[m] = batch[j];
+                }
+                ++m;
+            }
+        }
+        if (0 == m) {
+            return;
+        }
+
+        size_type n = size();
+        reserve(n + m);
+        for (size_type j = 0; j < m; ++j) {
+            keys.push_back(batch[0].first);
+            values.push_back(batch[0].second);
+        }
+        size_type i = n;
+        size_type k = n + m;
+        while (m > 0) {
+            --k;
+            if (i > 0 && comp(batch[m - 1].first, keys[i - 1])) {
+                --i;
+                keys[k] = keys[i];
+                values[k] = values[i];
+            } else {
+                --m;
+                keys[k] = batch[m].first;
+                values[k] = batch[m].second;
+            }
+        }
+    }
+
+    size_type erase(const Key& k)
+    {
+        size_type pos = find_index(k);
+        if (pos == size()) {
+            return 0;
+        }
+        index.clear();
+        size_type n = size();
+        for (size_type i = pos; i + 1 < n; ++i) {
+            keys[i] = keys[i + 1];
+            values[i] = values[i + 1];
+        }
+        keys.pop_back();
+        values.pop_back();
+        return 1;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,310 @@
+#ifndef MYSTL_MEMORY_RESOURCE_H_
+#define MYSTL_MEMORY_RESOURCE_H_
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include "alloc.h"
+
+// 有posix_memalign的平台以它配置超过max_align_t对齐的空间；定义__MYSTL_NO_POSIX_MEMALIGN可强制改用malloc上调
+#if !defined(__MYSTL_NO_POSIX_MEMALIGN) && (defined(__unix__) || defined(__APPLE__))
+# define __MYSTL_POSIX_MEMALIGN
+#endif
+
+/**
+ * @brief 多态内存资源（仿C++17 std::pmr）
+ * simple_alloc<T, Alloc>以模板参数选定配置器，全部是static函数：换一种配置器就要多实例化一份容器代码，
+ * 配置器本身也无法携带状态（例如“这个请求专用的arena”）。
+ * memory_resource把配置/释放抽象为虚函数，容器只保存一个memory_resource*，运行期即可切换配置器，
+ * 而容器代码对每个T只实例化一次。
+ *   alloc_resource<Alloc>：把任何SGI风格的static配置器（malloc_alloc、__default_alloc_template）包装成资源；
+ *   monotonic_buffer_resource：只配置不释放的arena，析构时一次归还全部内存。
+ */
+
+namespace mystl {
+
+namespace pmr {
+
+enum {__MAX_ALIGN = alignof(max_align_t)};
+
+/**
+ * @brief 配置按alignment对齐的空间，alignment为超过max_align_t的2的幂
+ * 没有posix_memalign时，以malloc多配置alignment字节，把起始位置上调到alignment的倍数，
+ * 原始地址存放在对齐后地址的前一格（上调量至少为max_align_t的对齐，放得下一个指针）
+ */
+inline void *__aligned_allocate(size_t bytes, size_t alignment)
+{
+#ifdef __MYSTL_POSIX_MEMALIGN
+    void *p = 0;
+    if (0 != posix_memalign(&p, alignment, bytes ? bytes : 1)) {
+        throw std::bad_alloc();
+    }
+    return p;
+#else
+    char *raw = (char *)malloc(bytes + alignment);
+    if (0 == raw) {
+        throw std::bad_alloc();
+    }
+    void **p = (void **)(((size_t)raw + alignment) & ~(alignment - 1));
+    p[-1] = raw;
+    return p;
+#endif
+}
+
+inline void __aligned_deallocate(void *p)
+{
+#ifdef __MYSTL_POSIX_MEMALIGN
+    free(p);
+#else
+    free(((void **)p)[-1]);
+#endif
+}
+
+class memory_resource {
+public:
+    virtual ~memory_resource() {}
+
+    void *allocate(size_t bytes, size_t alignment = __MAX_ALIGN)
+    {
+        return do_allocate(bytes, alignment);
+    }
+
+    void deallocate(void *p, size_t bytes, size_t alignment = __MAX_ALIGN)
+    {
+        do_deallocate(p, bytes, alignment);
+    }
+
+    bool is_equal(const memory_resource& x) const
+    {
+        return this == &x || do_is_equal(x);
+    }
+
+protected:
+    virtual void *do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void do_deallocate(void *p, size_t bytes, size_t alignment) = 0;
+    virtual bool do_is_equal(const memory_resource& x) const = 0;
+};
+
+inline bool operator==(const memory_resource& a, const memory_resource& b)
+{
+    return a.is_equal(b);
+}
+
+inline bool operator!=(const memory_resource& a, const memory_resource& b)
+{
+    return !(a == b);
+}
+
+/**
+ * @brief 把static配置器包装成memory_resource
+ * 第二级配置器的区块按8字节对齐，要求更严格的对齐时改用第一级配置器（malloc，保证max_align_t的对齐），
+ * 超过max_align_t的对齐以__aligned_allocate()配置（posix_memalign，或malloc后上调），配置失败时抛出bad_alloc。
+ * 释放时依据同样的alignment参数选回同一个配置器
+ */
+template <class Alloc>
+class alloc_resource : public memory_resource {
+protected:
+    void *do_allocate(size_t bytes, size_t alignment)
+    {
+        if (alignment > (size_t)__MAX_ALIGN) {
+            return __aligned_allocate(bytes, alignment);
+        }
+        if (alignment > (size_t)__ALIGN) {
+            return malloc_alloc::allocate(bytes);
+        }
+        return Alloc::allocate(bytes ? bytes : 1); // 第二级配置器不接受0字节的请求
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment)
+    {
+        if (alignment > (size_t)__MAX_ALIGN) {
+            __aligned_deallocate(p);
+        } else if (alignment > (size_t)__ALIGN) {
+            malloc_alloc::deallocate(p, bytes);
+        } else {
+            Alloc::deallocate(p, bytes ? bytes : 1);
+        }
+    }
+
+    // 同一个static配置器的所有包装彼此等价
+    bool do_is_equal(const memory_resource& x) const
+    {
+        return 0 != dynamic_cast<const alloc_resource *>(&x);
+    }
+};
+
+typedef alloc_resource<malloc_alloc>    malloc_resource;
+typedef alloc_resource<mystl::alloc>    default_alloc_resource;
+
+// 各static配置器对应的全局资源对象
+inline memory_resource *malloc_alloc_resource()
+{
+    static malloc_resource r;
+    return &r;
+}
+
+inline memory_resource *node_alloc_resource()
+{
+    static default_alloc_resource r;
+    return &r;
+}
+
+inline std::atomic<memory_resource*>& __default_resource()
+{
+    static std::atomic<memory_resource*> r(node_alloc_resource());
+    return r;
+}
+
+// 未指定资源的容器使用的缺省资源，初始为第二级配置器
+inline memory_resource *get_default_resource()
+{
+    return __default_resource().load(std::memory_order_acquire);
+}
+
+// 设置缺省资源，传入0时恢复为第二级配置器；返回原来的资源
+inline memory_resource *set_default_resource(memory_resource *r)
+{
+    return __default_resource().exchange(r ? r : node_alloc_resource(), std::memory_order_acq_rel);
+}
+
+/**
+ * @brief 单调递增的arena
+ * 从当前块中依次切出空间，deallocate()什么也不做；块用完时向upstream要一块两倍大的新块。
+ * 析构或release()时把所有块一次还给upstream，适合“一个请求用完即丢”的场合
+ */
+class monotonic_buffer_resource : public memory_resource {
+public:
+    explicit monotonic_buffer_resource(size_t initial_size = 1024,
+                                       memory_resource *upstream = get_default_resource())
+        : upstream_resource(upstream), blocks(0), cur(0), end(0),
+          next_size(initial_size < 64 ? 64 : initial_size) {}
+
+    ~monotonic_buffer_resource()
+    {
+        release();
+    }
+
+    void release()
+    {
+        while (blocks) {
+            block *next = blocks->next;
+            upstream_resource->deallocate(blocks, blocks->size, __MAX_ALIGN);
+            blocks = next;
+        }
+        cur = end = 0;
+    }
+
+    memory_resource *upstream() const
+    {
+        return upstream_resource;
+    }
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment)
+    {
+        char *p = align_up(cur, alignment);
+        if (0 == cur || p + bytes > end) {
+            new_block(bytes + alignment);
+            p = align_up(cur, alignment);
+        }
+        cur = p + bytes;
+        return p;
+    }
+
+    void do_deallocate(void *, size_t, size_t) {}
+
+    bool do_is_equal(const memory_resource& x) const
+    {
+        return this == &x;
+    }
+
+private:
+    struct block {
+        block *next;
+        size_t size;
+    };
+
+    memory_resource *upstream_resource;
+    block *blocks;
+    char *cur;
+    char *end;
+    size_t next_size;
+
+    static char *align_up(char *p, size_t alignment)
+    {
+        return (char *)(((size_t)p + alignment - 1) & ~(alignment - 1));
+    }
+
+    void new_block(size_t min_bytes)
+    {
+        size_t size = next_size;
+        while (size < min_bytes + sizeof(block)) {
+            size *= 2;
+        }
+        block *b = (block *)upstream_resource->allocate(size, __MAX_ALIGN);
+        b->next = blocks;
+        b->size = size;
+        blocks = b;
+        cur = (char *)(b + 1);
+        end = (char *)b + size;
+        next_size = size * 2;
+    }
+
+    monotonic_buffer_resource(const monotonic_buffer_resource&);
+    monotonic_buffer_resource& operator=(const monotonic_buffer_resource&);
+};
+
+/**
+ * @brief 以memory_resource*为状态的配置器
+ * 与simple_alloc的接口相同（以元素个数配置），但配置与释放是成员函数
+ */
+template <class T>
+class polymorphic_allocator {
+public:
+    typedef T value_type;
+
+    polymorphic_allocator() : resource_ptr(get_default_resource()) {}
+    polymorphic_allocator(memory_resource *r) : resource_ptr(r ? r : get_default_resource()) {}
+
+    template <class U>
+    polymorphic_allocator(const polymorphic_allocator<U>& x) : resource_ptr(x.resource()) {}
+
+    T *allocate(size_t n)
+    {
+        return 0 == n ? 0 : (T *)resource_ptr->allocate(n * sizeof(T), alignof(T));
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        if (0 != n) {
+            resource_ptr->deallocate(p, n * sizeof(T), alignof(T));
+        }
+    }
+
+    memory_resource *resource() const
+    {
+        return resource_ptr;
+    }
+
+private:
+    memory_resource *resource_ptr;
+};
+
+template <class T, class U>
+inline bool operator==(const polymorphic_allocator<T>& a, const polymorphic_allocator<U>& b)
+{
+    return *a.resource() == *b.resource();
+}
+
+template <class T, class U>
+inline bool operator!=(const polymorphic_allocator<T>& a, const polymorphic_allocator<U>& b)
+{
+    return !(a == b);
+}
+
+}
+
+}
+
+#endif
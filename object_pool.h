@@ -0,0 +1,428 @@
+#ifndef MYSTL_OBJECT_POOL_H_
+#define MYSTL_OBJECT_POOL_H_
+
+#include <stddef.h>
+#include <new>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+#include "alloc.h"
+#include "construct.h"
+#include "type_traits.h"
+
+/**
+ * @brief 定型对象池 object_pool<T>
+ * 与第二级配置器共用16个free list不同，object_pool为单一型别T维护一条独立的free list。
+ * 内存以slab（大块）为单位向Alloc索取，仿照chunk_alloc()/refill()的做法切割成若干个T大小的区块并串成free list。
+ * slab在池的生命期内从不归还，因此区块始终只被用来存放T（type-stable memory）。
+ * clear()一次性回收全部对象：若T具备trivial destructor，则不逐个调用析构函数。
+ */
+
+namespace mystl {
+
+// 锁策略：threads为false时什么也不做
+template <bool threads>
+struct __pool_lock {
+    void lock() {}
+    void unlock() {}
+};
+
+template <>
+struct __pool_lock<true> {
+    std::mutex m;
+    void lock() { m.lock(); }
+    void unlock() { m.unlock(); }
+};
+
+template <class T, bool threads = false, class Alloc = malloc_alloc>
+class object_pool {
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef size_t      size_type;
+
+    class cache;
+
+private:
+    union obj {
+        union obj *free_list_link; // 指向下一个空闲区块
+        char client_data[1];
+    };
+
+    // 每个slab的头部，所有slab串成单链表，供clear()和析构时遍历
+    struct slab {
+        slab *next;
+        size_type nobjs;
+        void *raw;          // Alloc配置所得的原始地址，slab本身按align()对齐
+    };
+
+    enum {__INIT_NOBJS = 32};     // 第一个slab的区块数
+    enum {__MAX_NOBJS = 4096};    // 单个slab区块数的上限
+
+    // 区块的对齐边界与大小：至少能放下一个指针
+    static size_type align()
+    {
+        return alignof(T) > alignof(obj) ? alignof(T) : alignof(obj);
+    }
+
+    static size_type ROUND_UP(size_type bytes)
+    {
+        return (bytes + align() - 1) & ~(align() - 1);
+    }
+
+    static size_type obj_size()
+    {
+        return ROUND_UP(sizeof(T) > sizeof(obj) ? sizeof(T) : sizeof(obj));
+    }
+
+    static size_type header_size()
+    {
+        return ROUND_UP(sizeof(slab));
+    }
+
+    static char *slab_data(slab *s)
+    {
+        return (char *)s + header_size();
+    }
+
+    // Alloc只保证基本的对齐，多配置align() - 1字节，以便把slab的起始位置上调到align()的倍数
+    static size_type slab_bytes(size_type nobjs)
+    {
+        return header_size() + nobjs * obj_size() + align() - 1;
+    }
+
+    obj *free_list;
+    slab *slabs;
+    size_type next_nobjs;   // 下一个slab的区块数，逐次倍增
+    size_type live;         // 已交给客端的对象个数
+    cache *caches;          // 所有存在中的cache，供clear()收回其中的区块
+    mutable __pool_lock<threads> mutex;
+
+    object_pool(const object_pool&);
+    object_pool& operator=(const object_pool&);
+
+public:
+    /**
+     * @brief 批量借出/归还区块的线程前端缓存
+     * 每个线程可持有一个cache（例如声明为thread_local），create/destroy只在缓存为空或溢出时
+     * 才以一次加锁与共享池整批交换区块。cache析构时把剩余区块还给池。
+     * 存活对象数的增减先记在cache中，随整批交换一并计入池，因此池的size()在flush()之前可能滞后。
+     * cache在构造时登记到池中，析构时注销，池的clear()据此收回各cache中的空闲区块。
+     */
+    class cache {
+    public:
+        explicit cache(object_pool &p, size_type batch = 32)
+            : pool(p), head(0), count(0), batch_size(batch ? batch : 1), live_delta(0), prev(0), next(0)
+        {
+            pool.attach(this);
+        }
+
+        ~cache()
+        {
+            flush();
+            pool.detach(this);
+        }
+
+        template <class... Args>
+        T *create(Args&&... args)
+        {
+            if (0 == head) {
+                count = pool.take_batch(head, batch_size, live_delta);
+            }
+            obj *result = head;
+            head = result->free_list_link;
+            --count;
+            T *p = (T *)result;
+            try {
+                new (p) T(std::forward<Args>(args)...);
+            } catch (...) {
+                result->free_list_link = head;
+                head = result;
+                ++count;
+                throw;
+            }
+            ++live_delta;
+            return p;
+        }
+
+        void destroy(T *p)
+        {
+            mystl::destroy(p);
+            obj *q = (obj *)p;
+            q->free_list_link = head;
+            head = q;
+            ++count;
+            --live_delta;
+            if (count >= 2 * batch_size) {
+                flush();
+            }
+        }
+
+        // 把缓存中的区块全部归还共享池，并计入累积的存活对象增减
+        void flush()
+        {
+            if (head || live_delta) {
+                pool.give_batch(head, count, live_delta);
+                head = 0;
+                count = 0;
+            }
+        }
+
+    private:
+        object_pool &pool;
+        obj *head;
+        size_type count;
+        size_type batch_size;
+        ptrdiff_t live_delta;   // 尚未计入池的存活对象增减
+        cache *prev;            // 池中登记的cache链表
+        cache *next;
+
+        friend class object_pool;
+
+        cache(const cache&);
+        cache& operator=(const cache&);
+    };
+
+    object_pool() : free_list(0), slabs(0), next_nobjs(__INIT_NOBJS), live(0), caches(0) {}
+
+    // 所有cache须先于池析构
+    ~object_pool()
+    {
+        clear();
+        while (slabs) {
+            slab *next = slabs->next;
+            Alloc::deallocate(slabs->raw, slab_bytes(slabs->nobjs));
+            slabs = next;
+        }
+    }
+
+    /**
+     * @brief 取一个区块并在其上构造T
+     * @param args 转交给T的构造函数
+     * @return T* 新对象
+     */
+    template <class... Args>
+    T *create(Args&&... args)
+    {
+        mutex.lock();
+        if (0 == free_list) {
+            refill();
+        }
+        obj *result = free_list;
+        free_list = result->free_list_link;
+        ++live;
+        mutex.unlock();
+
+        T *p = (T *)result;
+        try {
+            new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(result);
+            throw;
+        }
+        return p;
+    }
+
+    // 析构对象，并把区块放回free list
+    void destroy(T *p)
+    {
+        mystl::destroy(p);
+        deallocate((obj *)p);
+    }
+
+    size_type size() const
+    {
+        mutex.lock();
+        size_type n = live;
+        mutex.unlock();
+        return n;
+    }
+
+    // 池中已切割出的区块总数（含空闲区块）
+    size_type capacity() const
+    {
+        size_type n = 0;
+        mutex.lock();
+        for (slab *s = slabs; s; s = s->next) {
+            n += s->nobjs;
+        }
+        mutex.unlock();
+        return n;
+    }
+
+    /**
+     * @brief 一次回收池中全部对象，slab保留以便复用
+     * 先收回各cache中的空闲区块（否则它们会被当成存活对象），
+     * 若T有trivial destructor，直接重建free list；否则先析构所有仍存活的对象。
+     * 调用期间不得有其他线程使用本池或它的cache。
+     */
+    void clear()
+    {
+        mutex.lock();
+        for (cache *c = caches; c; c = c->next) {
+            reclaim(c);
+        }
+        typedef typename __type_traits<T>::has_trivial_destructor trivial_destructor;
+        if (live > 0) {
+            destroy_live(trivial_destructor());
+        }
+        free_list = 0;
+        for (slab *s = slabs; s; s = s->next) {
+            link_slab(s);
+        }
+        live = 0;
+        mutex.unlock();
+    }
+
+private:
+    void attach(cache *c)
+    {
+        mutex.lock();
+        c->next = caches;
+        if (caches) {
+            caches->prev = c;
+        }
+        caches = c;
+        mutex.unlock();
+    }
+
+    void detach(cache *c)
+    {
+        mutex.lock();
+        if (c->prev) {
+            c->prev->next = c->next;
+        } else {
+            caches = c->next;
+        }
+        if (c->next) {
+            c->next->prev = c->prev;
+        }
+        mutex.unlock();
+    }
+
+    // 把cache中的空闲区块接回共享free list，并计入其存活对象增减；调用者须持有锁
+    void reclaim(cache *c)
+    {
+        live += c->live_delta;
+        while (c->head) {
+            obj *q = c->head;
+            c->head = q->free_list_link;
+            q->free_list_link = free_list;
+            free_list = q;
+        }
+        c->count = 0;
+        c->live_delta = 0;
+    }
+
+    void deallocate(obj *q)
+    {
+        mutex.lock();
+        q->free_list_link = free_list;
+        free_list = q;
+        --live;
+        mutex.unlock();
+    }
+
+    // 从共享free list摘下最多n个区块，返回实际个数（至少1个）；顺便计入cache累积的存活对象增减
+    size_type take_batch(obj *&head, size_type n, ptrdiff_t& live_delta)
+    {
+        mutex.lock();
+        live += live_delta;
+        live_delta = 0;
+        if (0 == free_list) {
+            refill();
+        }
+        head = free_list;
+        obj *tail = free_list;
+        size_type got = 1;
+        while (got < n && tail->free_list_link) {
+            tail = tail->free_list_link;
+            ++got;
+        }
+        free_list = tail->free_list_link;
+        tail->free_list_link = 0;
+        mutex.unlock();
+        return got;
+    }
+
+    // 把一条长度为n的区块链整体接回共享free list（head可为0），并计入存活对象增减
+    void give_batch(obj *head, size_type n, ptrdiff_t& live_delta)
+    {
+        obj *tail = head;
+        for (size_type i = 1; i < n; ++i) {
+            tail = tail->free_list_link;
+        }
+        mutex.lock();
+        if (head) {
+            tail->free_list_link = free_list;
+            free_list = head;
+        }
+        live += live_delta;
+        live_delta = 0;
+        mutex.unlock();
+    }
+
+    // 配置一个新的slab，并将其区块全部编入free list
+    // 区块数每次倍增，与chunk_alloc()中随配置次数增大的附加量同一思路
+    void refill()
+    {
+        size_type nobjs = next_nobjs;
+        void *raw = Alloc::allocate(slab_bytes(nobjs));
+        slab *s = (slab *)(((size_t)raw + align() - 1) & ~(align() - 1));
+        s->raw = raw;
+        s->nobjs = nobjs;
+        s->next = slabs;
+        slabs = s;
+        if (next_nobjs < __MAX_NOBJS) {
+            next_nobjs *= 2;
+        }
+        link_slab(s);
+    }
+
+    // 在slab内建立free list，并接到现有free list之前
+    void link_slab(slab *s)
+    {
+        char *chunk = slab_data(s);
+        size_type n = obj_size();
+        for (size_type i = s->nobjs; i > 0; --i) {
+            obj *current_obj = (obj *)(chunk + (i - 1) * n);
+            current_obj->free_list_link = free_list;
+            free_list = current_obj;
+        }
+    }
+
+    void destroy_live(__true_type) {}
+
+    // 先把空闲区块的地址排序，再逐个slab扫描，不在其中的区块即为存活对象
+    void destroy_live(__false_type)
+    {
+        size_type nfree = 0;
+        for (obj *p = free_list; p; p = p->free_list_link) {
+            ++nfree;
+        }
+        obj **frees = nfree ? (obj **)Alloc::allocate(nfree * sizeof(obj *)) : 0;
+        size_type i = 0;
+        for (obj *p = free_list; p; p = p->free_list_link) {
+            frees[i++] = p;
+        }
+        std::sort(frees, frees + nfree);
+
+        size_type n = obj_size();
+        for (slab *s = slabs; s; s = s->next) {
+            char *chunk = slab_data(s);
+            for (size_type k = 0; k < s->nobjs; ++k) {
+                obj *q = (obj *)(chunk + k * n);
+                if (!std::binary_search(frees, frees + nfree, q)) {
+                    mystl::destroy((T *)q);
+                }
+            }
+        }
+        if (frees) {
+            Alloc::deallocate(frees, nfree * sizeof(obj *));
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,446 @@
+#ifndef MYSTL_PARALLEL_ALGO_H_
+#define MYSTL_PARALLEL_ALGO_H_
+
+#include <stddef.h>
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "thread_pool.h"
+
+/**
+ * @brief 并行算法
+ * parallel_sort / parallel_for_each / parallel_transform / parallel_reduce / parallel_inclusive_scan / parallel_copy
+ * 与SGI STL的做法一样，先用iterator_traits<>::iterator_category取得迭代器类型，再由重载决议在编译期选定版本：
+ *   random_access_iterator_tag：把区间对半切分，交给work_stealing_pool并行处理；
+ *   其余类型：退回顺序版本。
+ * std::的五种迭代器类型先换成对应的mystl类型，因此std::vector<T>::iterator等标准库迭代器同样走并行版本。
+ * 区间长度不超过__PARALLEL_THRESHOLD时，随机访问版本同样直接顺序执行，免去任务调度的开销。
+ */
+
+namespace mystl {
+
+enum {__PARALLEL_THRESHOLD = 4096}; // 小于此长度不再切分
+
+struct __parallel_less {
+    template <class T>
+    bool operator()(const T& a, const T& b) const { return a < b; }
+};
+
+// 把标准库迭代器的类型标签换成mystl的同名标签，mystl自己的标签原样保留
+template <class Category>
+struct __mystl_category {
+    typedef Category type;
+};
+
+template <>
+struct __mystl_category<std::input_iterator_tag> {
+    typedef input_iterator_tag type;
+};
+
+template <>
+struct __mystl_category<std::output_iterator_tag> {
+    typedef output_iterator_tag type;
+};
+
+template <>
+struct __mystl_category<std::forward_iterator_tag> {
+    typedef forward_iterator_tag type;
+};
+
+template <>
+struct __mystl_category<std::bidirectional_iterator_tag> {
+    typedef bidirectional_iterator_tag type;
+};
+
+template <>
+struct __mystl_category<std::random_access_iterator_tag> {
+    typedef random_access_iterator_tag type;
+};
+
+// 直接经由iterator_traits取得迭代器类型，避免与std::__iterator_category在ADL下产生歧义
+template <class Iterator>
+inline typename __mystl_category<typename iterator_traits<Iterator>::iterator_category>::type
+__category(const Iterator&)
+{
+    typedef typename __mystl_category<typename iterator_traits<Iterator>::iterator_category>::type category;
+    return category();
+}
+
+// 每块的最小长度：让每个线程大约分到8块，便于窃取时平衡负载
+template <class Distance>
+inline Distance __parallel_grain(work_stealing_pool& pool, Distance n)
+{
+    Distance grain = n / Distance(8 * pool.concurrency());
+    return grain < Distance(__PARALLEL_THRESHOLD) ? Distance(__PARALLEL_THRESHOLD) : grain;
+}
+
+/**
+ * @brief 并行区间切分的公共骨架
+ * 区间长度不超过grain时调用body(first, last)，否则对半切分，两半并行递归
+ */
+template <class RandomAccessIterator, class Distance, class Body>
+void __parallel_for(work_stealing_pool& pool, RandomAccessIterator first, RandomAccessIterator last,
+                    Distance grain, const Body& body)
+{
+    if (last - first <= grain) {
+        body(first, last);
+        return;
+    }
+    RandomAccessIterator mid = first + (last - first) / 2;
+    parallel_invoke(pool,
+                    [&] { __parallel_for(pool, first, mid, grain, body); },
+                    [&] { __parallel_for(pool, mid, last, grain, body); });
+}
+
+/*******************************************************************************************/
+// parallel_for_each
+
+template <class InputIterator, class Function>
+inline void __parallel_for_each(work_stealing_pool&, InputIterator first, InputIterator last,
+                                Function f, input_iterator_tag)
+{
+    for (; first != last; ++first) {
+        f(*first);
+    }
+}
+
+template <class RandomAccessIterator, class Function>
+inline void __parallel_for_each(work_stealing_pool& pool, RandomAccessIterator first, RandomAccessIterator last,
+                                Function f, random_access_iterator_tag)
+{
+    __parallel_for(pool, first, last, __parallel_grain(pool, last - first),
+                   [&f](RandomAccessIterator b, RandomAccessIterator e) {
+                       for (; b != e; ++b) {
+                           f(*b);
+                       }
+                   });
+}
+
+// f会被多个线程同时调用
+template <class InputIterator, class Function>
+inline void parallel_for_each(InputIterator first, InputIterator last, Function f)
+{
+    __parallel_for_each(work_stealing_pool::instance(), first, last, f, __category(first));
+}
+
+/*******************************************************************************************/
+// parallel_transform
+
+template <class InputIterator, class OutputIterator, class UnaryOperation, class Tag1, class Tag2>
+inline OutputIterator __parallel_transform(work_stealing_pool&, InputIterator first, InputIterator last,
+                                           OutputIterator result, UnaryOperation op, Tag1, Tag2)
+{
+    for (; first != last; ++first, ++result) {
+        *result = op(*first);
+    }
+    return result;
+}
+
+// 输入与输出都必须是随机访问迭代器，才能独立地处理每一块
+template <class RandomAccessIterator1, class RandomAccessIterator2, class UnaryOperation>
+inline RandomAccessIterator2
+__parallel_transform(work_stealing_pool& pool, RandomAccessIterator1 first, RandomAccessIterator1 last,
+                     RandomAccessIterator2 result, UnaryOperation op,
+                     random_access_iterator_tag, random_access_iterator_tag)
+{
+    __parallel_for(pool, first, last, __parallel_grain(pool, last - first),
+                   [&](RandomAccessIterator1 b, RandomAccessIterator1 e) {
+                       RandomAccessIterator2 out = result + (b - first);
+                       for (; b != e; ++b, ++out) {
+                           *out = op(*b);
+                       }
+                   });
+    return result + (last - first);
+}
+
+template <class InputIterator, class OutputIterator, class UnaryOperation>
+inline OutputIterator parallel_transform(InputIterator first, InputIterator last,
+                                         OutputIterator result, UnaryOperation op)
+{
+    return __parallel_transform(work_stealing_pool::instance(), first, last, result, op,
+                                __category(first), __category(result));
+}
+
+/*******************************************************************************************/
+// parallel_copy
+
+template <class InputIterator, class OutputIterator>
+inline OutputIterator __parallel_copy(work_stealing_pool& pool, InputIterator first, InputIterator last,
+                                      OutputIterator result)
+{
+    typedef typename iterator_traits<InputIterator>::reference reference;
+    return __parallel_transform(pool, first, last, result, [](reference x) -> reference { return x; },
+                                __category(first), __category(result));
+}
+
+template <class InputIterator, class OutputIterator>
+inline OutputIterator parallel_copy(InputIterator first, InputIterator last, OutputIterator result)
+{
+    return __parallel_copy(work_stealing_pool::instance(), first, last, result);
+}
+
+/*******************************************************************************************/
+// parallel_reduce
+
+template <class InputIterator, class T, class BinaryOperation>
+inline T __parallel_reduce(work_stealing_pool&, InputIterator first, InputIterator last,
+                           T init, BinaryOperation op, input_iterator_tag)
+{
+    for (; first != last; ++first) {
+        init = op(init, *first);
+    }
+    return init;
+}
+
+// 计算非空区间[first, last)的归约值
+template <class RandomAccessIterator, class T, class Distance, class BinaryOperation>
+T __parallel_reduce_aux(work_stealing_pool& pool, RandomAccessIterator first, RandomAccessIterator last,
+                        Distance grain, BinaryOperation& op)
+{
+    if (last - first <= grain) {
+        T result = *first;
+        for (++first; first != last; ++first) {
+            result = op(result, *first);
+        }
+        return result;
+    }
+    RandomAccessIterator mid = first + (last - first) / 2;
+    T *left = 0;
+    T *right = 0;
+    // 两半的结果各自构造在栈上的原始空间里，T无须有默认构造函数
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type left_buf, right_buf;
+    parallel_invoke(pool,
+                    [&] { left = new (&left_buf) T(__parallel_reduce_aux<RandomAccessIterator, T>(pool, first, mid, grain, op)); },
+                    [&] { right = new (&right_buf) T(__parallel_reduce_aux<RandomAccessIterator, T>(pool, mid, last, grain, op)); });
+    T result = op(*left, *right);
+    mystl::destroy(left);
+    mystl::destroy(right);
+    return result;
+}
+
+template <class RandomAccessIterator, class T, class BinaryOperation>
+inline T __parallel_reduce(work_stealing_pool& pool, RandomAccessIterator first, RandomAccessIterator last,
+                           T init, BinaryOperation op, random_access_iterator_tag)
+{
+    if (first == last) {
+        return init;
+    }
+    return op(init, __parallel_reduce_aux<RandomAccessIterator, T>(pool, first, last,
+                                                                   __parallel_grain(pool, last - first), op));
+}
+
+// op必须满足结合律；各块的结果按原顺序合并，因此不要求交换律
+template <class InputIterator, class T, class BinaryOperation>
+inline T parallel_reduce(InputIterator first, InputIterator last, T init, BinaryOperation op)
+{
+    return __parallel_reduce(work_stealing_pool::instance(), first, last, init, op, __category(first));
+}
+
+template <class InputIterator, class T>
+inline T parallel_reduce(InputIterator first, InputIterator last, T init)
+{
+    return parallel_reduce(first, last, init, [](const T& a, const T& b) { return a + b; });
+}
+
+/*******************************************************************************************/
+// parallel_inclusive_scan
+
+template <class InputIterator, class OutputIterator, class BinaryOperation, class Tag1, class Tag2>
+OutputIterator __parallel_inclusive_scan(work_stealing_pool&, InputIterator first, InputIterator last,
+                                         OutputIterator result, BinaryOperation op, Tag1, Tag2)
+{
+    if (first == last) {
+        return result;
+    }
+    typename iterator_traits<InputIterator>::value_type sum = *first;
+    *result = sum;
+    for (++first, ++result; first != last; ++first, ++result) {
+        sum = op(sum, *first);
+        *result = sum;
+    }
+    return result;
+}
+
+/**
+ * @brief 两遍扫描的并行前缀和
+ * 第一遍并行求出每块的归约值；顺序累加得到每块的起始前缀；第二遍各块带着起始前缀并行扫描
+ */
+template <class RandomAccessIterator1, class RandomAccessIterator2, class BinaryOperation>
+RandomAccessIterator2
+__parallel_inclusive_scan(work_stealing_pool& pool, RandomAccessIterator1 first, RandomAccessIterator1 last,
+                          RandomAccessIterator2 result, BinaryOperation op,
+                          random_access_iterator_tag, random_access_iterator_tag)
+{
+    typedef typename iterator_traits<RandomAccessIterator1>::value_type T;
+    typedef typename iterator_traits<RandomAccessIterator1>::difference_type Distance;
+    typedef mystl::simple_alloc<T, mystl::alloc> data_allocator;
+
+    Distance n = last - first;
+    Distance grain = __parallel_grain(pool, n);
+    if (n <= grain) {
+        return __parallel_inclusive_scan(pool, first, last, result, op,
+                                         input_iterator_tag(), output_iterator_tag());
+    }
+    Distance nblocks = (n + grain - 1) / grain;
+    T *sums = data_allocator::allocate(nblocks);
+
+    {
+        task_group group(pool);
+        for (Distance b = 0; b + 1 < nblocks; ++b) {
+            group.run([=, &op] {
+                RandomAccessIterator1 i = first + b * grain;
+                RandomAccessIterator1 e = i + grain;
+                T s = *i;
+                for (++i; i != e; ++i) {
+                    s = op(s, *i);
+                }
+                mystl::construct(sums + b, s);
+            });
+        }
+        group.wait();
+    }
+
+    // sums[b]改为第b+1块之前全部元素的前缀
+    for (Distance b = 1; b + 1 < nblocks; ++b) {
+        sums[b] = op(sums[b - 1], sums[b]);
+    }
+
+    {
+        task_group group(pool);
+        for (Distance b = 0; b < nblocks; ++b) {
+            group.run([=, &op] {
+                RandomAccessIterator1 i = first + b * grain;
+                RandomAccessIterator1 e = b + 1 == nblocks ? last : i + grain;
+                RandomAccessIterator2 out = result + b * grain;
+                T s = b == 0 ? T(*i) : op(sums[b - 1], *i);
+                *out = s;
+                for (++i, ++out; i != e; ++i, ++out) {
+                    s = op(s, *i);
+                    *out = s;
+                }
+            });
+        }
+        group.wait();
+    }
+
+    for (Distance b = 0; b + 1 < nblocks; ++b) {
+        mystl::destroy(sums + b);
+    }
+    data_allocator::deallocate(sums, nblocks);
+    return result + n;
+}
+
+// op必须满足结合律
+template <class InputIterator, class OutputIterator, class BinaryOperation>
+inline OutputIterator parallel_inclusive_scan(InputIterator first, InputIterator last,
+                                              OutputIterator result, BinaryOperation op)
+{
+    return __parallel_inclusive_scan(work_stealing_pool::instance(), first, last, result, op,
+                                     __category(first), __category(result));
+}
+
+template <class InputIterator, class OutputIterator>
+inline OutputIterator parallel_inclusive_scan(InputIterator first, InputIterator last, OutputIterator result)
+{
+    typedef typename iterator_traits<InputIterator>::value_type T;
+    return parallel_inclusive_scan(first, last, result, [](const T& a, const T& b) { return a + b; });
+}
+
+/*******************************************************************************************/
+// parallel_sort
+
+template <class T, class Compare>
+inline const T& __median(const T& a, const T& b, const T& c, Compare comp)
+{
+    if (comp(a, b)) {
+        if (comp(b, c)) {
+            return b;
+        } else if (comp(a, c)) {
+            return c;
+        } else {
+            return a;
+        }
+    } else if (comp(a, c)) {
+        return a;
+    } else if (comp(b, c)) {
+        return c;
+    } else {
+        return b;
+    }
+}
+
+// 与SGI introsort相同的无边界检查分割，pivot取三点中值，保证两个内层循环不会越界
+template <class RandomAccessIterator, class T, class Compare>
+RandomAccessIterator __parallel_partition(RandomAccessIterator first, RandomAccessIterator last,
+                                          T pivot, Compare comp)
+{
+    for (;;) {
+        while (comp(*first, pivot)) {
+            ++first;
+        }
+        --last;
+        while (comp(pivot, *last)) {
+            --last;
+        }
+        if (!(first < last)) {
+            return first;
+        }
+        std::iter_swap(first, last);
+        ++first;
+    }
+}
+
+/**
+ * @brief 并行快速排序
+ * 分割后两段并行递归；区间小于grain或递归过深时交给顺序的introsort，保证最坏情况仍为O(nlogn)
+ */
+template <class RandomAccessIterator, class Distance, class Compare>
+void __parallel_sort_loop(work_stealing_pool& pool, RandomAccessIterator first, RandomAccessIterator last,
+                          Distance grain, int depth_limit, Compare& comp)
+{
+    if (last - first <= grain || 0 == depth_limit) {
+        std::sort(first, last, comp);
+        return;
+    }
+    typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+    RandomAccessIterator cut = __parallel_partition(first, last,
+                                                    T(__median(*first, *(first + (last - first) / 2),
+                                                               *(last - 1), comp)),
+                                                    comp);
+    parallel_invoke(pool,
+                    [&] { __parallel_sort_loop(pool, first, cut, grain, depth_limit - 1, comp); },
+                    [&] { __parallel_sort_loop(pool, cut, last, grain, depth_limit - 1, comp); });
+}
+
+template <class RandomAccessIterator, class Compare>
+inline void __parallel_sort(work_stealing_pool& pool, RandomAccessIterator first, RandomAccessIterator last,
+                            Compare comp, random_access_iterator_tag)
+{
+    int depth_limit = 0;
+    for (ptrdiff_t n = last - first; n > 1; n >>= 1) {
+        depth_limit += 2;
+    }
+    __parallel_sort_loop(pool, first, last, __parallel_grain(pool, last - first), depth_limit, comp);
+}
+
+// 排序只定义随机访问迭代器版本
+template <class RandomAccessIterator, class Compare>
+inline void parallel_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp)
+{
+    __parallel_sort(work_stealing_pool::instance(), first, last, comp, __category(first));
+}
+
+template <class RandomAccessIterator>
+inline void parallel_sort(RandomAccessIterator first, RandomAccessIterator last)
+{
+    parallel_sort(first, last, __parallel_less());
+}
+
+}
+
+#endif
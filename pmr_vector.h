@@ -0,0 +1,101 @@
+#ifndef MYSTL_PMR_VECTOR_H_
+#define MYSTL_PMR_VECTOR_H_
+
+#include <stddef.h>
+#include "memory_resource.h"
+#include "vector.h"
+
+/**
+ * @brief 使用memory_resource的pmr::Vector
+ * 算法全部沿用mystl::Vector，只把配置策略换成__pmr_vector_policy：对象中保存一个polymorphic_allocator，
+ * 而不是以模板参数选定static配置器。不论元素使用哪种资源，pmr::Vector<T>只实例化一份代码；
+ * 同一个请求的所有容器可以共用一个arena。
+ * 复制构造沿用缺省资源（与std::pmr一致，资源不随复制传播），交换只在两者资源相等时才交换指针。
+ */
+
+namespace mystl {
+
+namespace pmr {
+
+// 经由保存的polymorphic_allocator配置空间
+template <class T>
+class __pmr_vector_policy {
+public:
+    explicit __pmr_vector_policy(memory_resource *r = get_default_resource()) : data_allocator(r) {}
+
+protected:
+    polymorphic_allocator<T> data_allocator;
+
+    T *allocate_storage(size_t n)
+    {
+        return data_allocator.allocate(n);
+    }
+
+    void deallocate_storage(T *p, size_t n)
+    {
+        data_allocator.deallocate(p, n);
+    }
+};
+
+template <class T>
+class Vector : public mystl::Vector<T, mystl::alloc, __pmr_vector_policy<T> > {
+    typedef mystl::Vector<T, mystl::alloc, __pmr_vector_policy<T> > base;
+    typedef __pmr_vector_policy<T> policy;
+
+public:
+    typedef typename base::size_type    size_type;
+    typedef typename base::iterator     iterator;
+    typedef polymorphic_allocator<T>    allocator_type;
+
+    explicit Vector(memory_resource *r = get_default_resource()) : base(policy(r)) {}
+
+    Vector(size_type n, const T& value, memory_resource *r = get_default_resource()) : base(policy(r))
+    {
+        this->insert(this->end(), n, value);
+    }
+
+    Vector(const Vector& x, memory_resource *r = get_default_resource()) : base(policy(r))
+    {
+        base::operator=(x);
+    }
+
+    // 移动构造沿用x的资源，只接过三个指针
+    Vector(Vector&& x) : base(policy(x.resource()))
+    {
+        base::swap(x);
+    }
+
+    Vector& operator=(const Vector& x)
+    {
+        base::operator=(x);
+        return *this;
+    }
+
+    memory_resource *resource() const
+    {
+        return this->data_allocator.resource();
+    }
+
+    allocator_type get_allocator() const
+    {
+        return this->data_allocator;
+    }
+
+    // 资源相等时只交换指针，否则逐个元素交换内容
+    void swap(Vector& x)
+    {
+        if (*resource() == *x.resource()) {
+            base::swap(x);
+        } else {
+            Vector tmp(*this, resource());
+            *this = x;
+            x = tmp;
+        }
+    }
+};
+
+}
+
+}
+
+#endif
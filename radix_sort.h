@@ -0,0 +1,274 @@
+#ifndef MYSTL_RADIX_SORT_H_
+#define MYSTL_RADIX_SORT_H_
+
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+#include "thread_pool.h"
+
+/**
+ * @brief LSD基数排序
+ * radix_sort(first, last [, key])：按key(*it)的值做稳定排序，key缺省为元素本身。
+ * 与__uninitialized_copy相同，先以__radix_traits<Key>::is_radix_key判断键的型别：
+ *   __radix_traits有特化的键（整数、float、double）走基数排序：每轮处理8位数字，共sizeof(Key)轮；
+ *   其他键（包括long double、指针等POD型别）退回std::stable_sort，保持相同的稳定性语义。
+ * 所有轮次的直方图在一遍扫描中同时求出；某一轮所有键的该位数字都相同时，这一轮直接跳过。
+ * 暂存空间由mystl::alloc配置，元素在原区间与暂存空间之间来回搬移。
+ * 迭代器须指向连续空间（如Vector<T>::iterator或原生指针）。
+ * parallel_radix_sort()把直方图阶段分块交给work_stealing_pool并行统计。
+ */
+
+namespace mystl {
+
+enum {__RADIX_BITS = 8};
+enum {__RADIX_BUCKETS = 1 << __RADIX_BITS};
+enum {__RADIX_PARALLEL_THRESHOLD = 1 << 16}; // 小于此长度不并行统计直方图
+
+/**
+ * @brief 把键映射为无号整数，使无号整数的大小顺序与键的大小顺序一致
+ * 无号整数：原样；有号整数：翻转符号位；
+ * 浮点数：正数翻转符号位，负数翻转全部位（-0.0排在+0.0之前，NaN按位模式排在两端）
+ */
+template <class Key>
+struct __radix_traits {
+    typedef __false_type is_radix_key;  // 未特化的键型别不能做基数排序
+};
+
+#define __MYSTL_RADIX_UNSIGNED(K, U)                                    \
+template <>                                                             \
+struct __radix_traits<K> {                                              \
+    typedef __true_type is_radix_key;                                   \
+    typedef U bits_type;                                                \
+    static bits_type encode(K k) { return (bits_type)k; }               \
+};
+
+#define __MYSTL_RADIX_SIGNED(K, U)                                      \
+template <>                                                             \
+struct __radix_traits<K> {                                              \
+    typedef __true_type is_radix_key;                                   \
+    typedef U bits_type;                                                \
+    static bits_type encode(K k)                                        \
+    {                                                                   \
+        return (bits_type)k ^ ((bits_type)1 << (sizeof(K) * 8 - 1));    \
+    }                                                                   \
+};
+
+#define __MYSTL_RADIX_FLOAT(K, U)                                       \
+template <>                                                             \
+struct __radix_traits<K> {                                              \
+    typedef __true_type is_radix_key;                                   \
+    typedef U bits_type;                                                \
+    static bits_type encode(K k)                                        \
+    {                                                                   \
+        bits_type u;                                                    \
+        memcpy(&u, &k, sizeof(K));                                      \
+        bits_type sign = (bits_type)1 << (sizeof(K) * 8 - 1);           \
+        return (u & sign) ? ~u : (u | sign);                            \
+    }                                                                   \
+};
+
+__MYSTL_RADIX_UNSIGNED(unsigned char, unsigned char)
+__MYSTL_RADIX_UNSIGNED(unsigned short, unsigned short)
+__MYSTL_RADIX_UNSIGNED(unsigned int, unsigned int)
+__MYSTL_RADIX_UNSIGNED(unsigned long, unsigned long)
+__MYSTL_RADIX_UNSIGNED(unsigned long long, unsigned long long)
+__MYSTL_RADIX_SIGNED(signed char, unsigned char)
+__MYSTL_RADIX_SIGNED(short, unsigned short)
+__MYSTL_RADIX_SIGNED(int, unsigned int)
+__MYSTL_RADIX_SIGNED(long, unsigned long)
+__MYSTL_RADIX_SIGNED(long long, unsigned long long)
+__MYSTL_RADIX_FLOAT(float, unsigned int)
+__MYSTL_RADIX_FLOAT(double, unsigned long long)
+
+// char是否有号由平台决定
+template <>
+struct __radix_traits<char> {
+    typedef __true_type is_radix_key;
+    typedef unsigned char bits_type;
+    static bits_type encode(char k)
+    {
+        return (bits_type)k ^ (char(-1) < 0 ? 0x80 : 0);
+    }
+};
+
+#undef __MYSTL_RADIX_UNSIGNED
+#undef __MYSTL_RADIX_SIGNED
+#undef __MYSTL_RADIX_FLOAT
+
+// 缺省的键：元素本身
+struct __radix_identity {
+    template <class T>
+    const T& operator()(const T& x) const { return x; }
+};
+
+// 统计[first, last)中各轮各数字出现的次数，count[pass * __RADIX_BUCKETS + digit]
+template <class T, class KeyOf>
+void __radix_histogram(const T *first, const T *last, KeyOf& key, size_t *count)
+{
+    typedef typename std::decay<decltype(key(*first))>::type Key;
+    typedef typename __radix_traits<Key>::bits_type bits_type;
+    const size_t passes = sizeof(bits_type);
+    for (; first != last; ++first) {
+        bits_type u = __radix_traits<Key>::encode(key(*first));
+        for (size_t pass = 0; pass < passes; ++pass) {
+            ++count[pass * __RADIX_BUCKETS + ((u >> (pass * __RADIX_BITS)) & (__RADIX_BUCKETS - 1))];
+        }
+    }
+}
+
+// 分块并行统计，各块的计数最后逐项相加
+template <class T, class KeyOf>
+void __radix_parallel_histogram(work_stealing_pool& pool, const T *first, const T *last,
+                                KeyOf& key, size_t *count, size_t nslots)
+{
+    typedef mystl::simple_alloc<size_t, mystl::alloc> count_allocator;
+    size_t n = last - first;
+    size_t nblocks = pool.concurrency();
+    size_t block = (n + nblocks - 1) / nblocks;
+    size_t *local = count_allocator::allocate(nblocks * nslots);
+    memset(local, 0, sizeof(size_t) * nblocks * nslots);
+    {
+        task_group group(pool);
+        for (size_t b = 0; b < nblocks; ++b) {
+            const T *bf = first + std::min(n, b * block);
+            const T *bl = first + std::min(n, (b + 1) * block);
+            size_t *c = local + b * nslots;
+            group.run([bf, bl, c, &key] { __radix_histogram(bf, bl, key, c); });
+        }
+        group.wait();
+    }
+    for (size_t b = 0; b < nblocks; ++b) {
+        for (size_t i = 0; i < nslots; ++i) {
+            count[i] += local[b * nslots + i];
+        }
+    }
+    count_allocator::deallocate(local, nblocks * nslots);
+}
+
+// 把原始空间中的元素搬到另一段原始空间，并析构旧元素
+template <class T>
+inline void __radix_relocate(T *dst, T *src)
+{
+    new (dst) T(std::move(*src));
+    mystl::destroy(src);
+}
+
+template <class T, class KeyOf>
+void __radix_sort_aux(T *first, T *last, KeyOf key, work_stealing_pool *pool)
+{
+    typedef typename std::decay<decltype(key(*first))>::type Key;
+    typedef typename __radix_traits<Key>::bits_type bits_type;
+    typedef mystl::simple_alloc<T, mystl::alloc> data_allocator;
+    const size_t passes = sizeof(bits_type);
+    const size_t nslots = passes * __RADIX_BUCKETS;
+
+    size_t n = last - first;
+    if (n < 2) {
+        return;
+    }
+    size_t count[sizeof(bits_type) * __RADIX_BUCKETS];
+    memset(count, 0, sizeof(count));
+    if (pool && n >= (size_t)__RADIX_PARALLEL_THRESHOLD) {
+        __radix_parallel_histogram(*pool, first, last, key, count, nslots);
+    } else {
+        __radix_histogram(first, last, key, count);
+    }
+
+    T *buffer = data_allocator::allocate(n);
+    T *src = first;
+    T *dst = buffer;
+    for (size_t pass = 0; pass < passes; ++pass) {
+        size_t *c = count + pass * __RADIX_BUCKETS;
+        size_t shift = pass * __RADIX_BITS;
+        // 所有键这一位都相同，本轮不改变次序
+        if (c[(__radix_traits<Key>::encode(key(*src)) >> shift) & (__RADIX_BUCKETS - 1)] == n) {
+            continue;
+        }
+        // 计数转为各桶的起始位置
+        size_t offset = 0;
+        for (size_t d = 0; d < __RADIX_BUCKETS; ++d) {
+            size_t tmp = c[d];
+            c[d] = offset;
+            offset += tmp;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            size_t d = (__radix_traits<Key>::encode(key(src[i])) >> shift) & (__RADIX_BUCKETS - 1);
+            __radix_relocate(dst + c[d]++, src + i);
+        }
+        std::swap(src, dst);
+    }
+    if (src != first) {
+        for (size_t i = 0; i < n; ++i) {
+            __radix_relocate(first + i, src + i);
+        }
+    }
+    data_allocator::deallocate(buffer, n);
+}
+
+template <class RandomAccessIterator, class KeyOf>
+inline void __radix_sort(RandomAccessIterator first, RandomAccessIterator last, KeyOf key,
+                         work_stealing_pool *pool, __true_type)
+{
+    if (first != last) {
+        __radix_sort_aux(&*first, &*first + (last - first), key, pool);
+    }
+}
+
+// 不能做基数排序的键：退回比较排序
+template <class RandomAccessIterator, class KeyOf>
+inline void __radix_sort(RandomAccessIterator first, RandomAccessIterator last, KeyOf key,
+                         work_stealing_pool *, __false_type)
+{
+    typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+    std::stable_sort(first, last, [&key](const T& a, const T& b) { return key(a) < key(b); });
+}
+
+template <class RandomAccessIterator, class KeyOf>
+inline void __radix_sort_dispatch(RandomAccessIterator first, RandomAccessIterator last, KeyOf key,
+                                  work_stealing_pool *pool)
+{
+    typedef typename std::decay<decltype(key(*first))>::type Key;
+    typedef typename __radix_traits<Key>::is_radix_key is_radix_key;
+    __radix_sort(first, last, key, pool, is_radix_key());
+}
+
+/**
+ * @brief 按key(*it)稳定排序
+ * @param key 从元素中取出排序键，键为整数或浮点数时使用基数排序
+ */
+template <class RandomAccessIterator, class KeyOf>
+inline void radix_sort(RandomAccessIterator first, RandomAccessIterator last, KeyOf key)
+{
+    __radix_sort_dispatch(first, last, key, (work_stealing_pool *)0);
+}
+
+template <class RandomAccessIterator>
+inline void radix_sort(RandomAccessIterator first, RandomAccessIterator last)
+{
+    radix_sort(first, last, __radix_identity());
+}
+
+// 与radix_sort相同，但直方图阶段分块并行统计
+template <class RandomAccessIterator, class KeyOf>
+inline void parallel_radix_sort(RandomAccessIterator first, RandomAccessIterator last, KeyOf key,
+                                work_stealing_pool& pool = work_stealing_pool::instance())
+{
+    __radix_sort_dispatch(first, last, key, &pool);
+}
+
+template <class RandomAccessIterator>
+inline void parallel_radix_sort(RandomAccessIterator first, RandomAccessIterator last)
+{
+    parallel_radix_sort(first, last, __radix_identity());
+}
+
+}
+
+#endif
@@ -0,0 +1,597 @@
+#ifndef MYSTL_RANGE_VIEW_H_
+#define MYSTL_RANGE_VIEW_H_
+
+#include <stddef.h>
+#include <type_traits>
+#include <utility>
+#include "iterator.h"
+#include "vector.h"
+
+/**
+ * @brief 惰性区间视图
+ * filter / transform / take / zip / chunk 都不复制元素，只是把底层迭代器包装成新的迭代器，
+ * 解引用时才逐个元素地计算。多个视图用 | 串接后，遍历一次即完成全部步骤，不产生中间Vector：
+ *     Vector<int> out;
+ *     to_vector(all(v) | filter(is_odd) | transform(square) | take(10), out);
+ * 包装后的迭代器类型由底层迭代器的iterator_category推得，视图的迭代器能随机访问时，
+ * to_vector()先一次性reserve()结果的大小，再逐个push_back。
+ * 视图内部保存谓词/函数对象，迭代器只持有指向它们的指针，因此视图须比其迭代器活得久。
+ */
+
+namespace mystl {
+
+// 所有视图的公共基类，仅用于识别“这是一个视图”
+struct __view_base {};
+
+// 两个迭代器类型中较弱的一个（较强的类型由较弱的类型派生而来）
+template <class Tag1, class Tag2>
+struct __weaker_tag {
+    typedef typename std::conditional<std::is_base_of<Tag1, Tag2>::value, Tag1, Tag2>::type type;
+};
+
+template <class Iterator>
+struct __is_random_access
+    : std::is_base_of<random_access_iterator_tag, typename iterator_traits<Iterator>::iterator_category> {};
+
+template <class Iterator>
+class iterator_range : public __view_base {
+public:
+    typedef Iterator iterator;
+
+    iterator_range() : first(), last() {}
+    iterator_range(Iterator f, Iterator l) : first(f), last(l) {}
+
+    Iterator begin() const { return first; }
+    Iterator end() const { return last; }
+    bool empty() const { return first == last; }
+
+private:
+    Iterator first;
+    Iterator last;
+};
+
+template <class Iterator>
+inline iterator_range<Iterator> make_range(Iterator first, Iterator last)
+{
+    return iterator_range<Iterator>(first, last);
+}
+
+// 以容器的[begin(), end())作为视图的起点
+template <class Container>
+inline iterator_range<typename Container::iterator> all(Container& c)
+{
+    return iterator_range<typename Container::iterator>(c.begin(), c.end());
+}
+
+template <class Container>
+inline iterator_range<typename Container::const_iterator> all(const Container& c)
+{
+    return iterator_range<typename Container::const_iterator>(c.begin(), c.end());
+}
+
+/**
+ * @brief 视图按值保存；容器则改用iterator_range引用它的元素，从不复制容器
+ * const容器得到由const_iterator组成的iterator_range，经视图只能读取元素
+ */
+template <class Range, bool = std::is_base_of<__view_base, typename std::remove_const<Range>::type>::value>
+struct __view_of {
+    typedef typename std::remove_const<Range>::type type;
+    static const type& make(const type& r) { return r; }
+};
+
+template <class Range>
+struct __view_of<Range, false> {
+    typedef iterator_range<typename Range::iterator> type;
+    static type make(Range& r) { return type(r.begin(), r.end()); }
+};
+
+template <class Range>
+struct __view_of<const Range, false> {
+    typedef iterator_range<typename Range::const_iterator> type;
+    static type make(const Range& r) { return type(r.begin(), r.end()); }
+};
+
+/*******************************************************************************************/
+// filter
+
+template <class Iterator, class Predicate>
+class filter_iterator {
+public:
+    typedef typename __weaker_tag<forward_iterator_tag,
+                                  typename iterator_traits<Iterator>::iterator_category>::type iterator_category;
+    typedef typename iterator_traits<Iterator>::value_type        value_type;
+    typedef typename iterator_traits<Iterator>::difference_type   difference_type;
+    typedef typename iterator_traits<Iterator>::pointer           pointer;
+    typedef typename iterator_traits<Iterator>::reference         reference;
+
+    filter_iterator() : cur(), last(), pred(0) {}
+    filter_iterator(Iterator c, Iterator l, const Predicate *p) : cur(c), last(l), pred(p)
+    {
+        satisfy();
+    }
+
+    reference operator*() const { return *cur; }
+
+    filter_iterator& operator++()
+    {
+        ++cur;
+        satisfy();
+        return *this;
+    }
+
+    filter_iterator operator++(int)
+    {
+        filter_iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const filter_iterator& x) const { return cur == x.cur; }
+    bool operator!=(const filter_iterator& x) const { return cur != x.cur; }
+
+private:
+    Iterator cur;
+    Iterator last;
+    const Predicate *pred;
+
+    // 跳过不满足谓词的元素
+    void satisfy()
+    {
+        while (cur != last && !(*pred)(*cur)) {
+            ++cur;
+        }
+    }
+};
+
+template <class Range, class Predicate>
+class filter_view : public __view_base {
+public:
+    typedef filter_iterator<typename Range::iterator, Predicate> iterator;
+
+    filter_view(const Range& r, const Predicate& p) : base(r), pred(p) {}
+
+    iterator begin() const { return iterator(base.begin(), base.end(), &pred); }
+    iterator end() const { return iterator(base.end(), base.end(), &pred); }
+
+private:
+    Range base;
+    Predicate pred;
+};
+
+template <class Predicate>
+struct __filter_adaptor {
+    Predicate pred;
+};
+
+// 只保留pred(x)为真的元素
+template <class Predicate>
+inline __filter_adaptor<Predicate> filter(Predicate pred)
+{
+    __filter_adaptor<Predicate> a = { pred };
+    return a;
+}
+
+template <class Range, class Predicate>
+inline filter_view<typename __view_of<Range>::type, Predicate>
+operator|(Range& r, const __filter_adaptor<Predicate>& a)
+{
+    return filter_view<typename __view_of<Range>::type, Predicate>(__view_of<Range>::make(r), a.pred);
+}
+
+template <class Range, class Predicate>
+inline filter_view<typename __view_of<const Range>::type, Predicate>
+operator|(const Range& r, const __filter_adaptor<Predicate>& a)
+{
+    return filter_view<typename __view_of<const Range>::type, Predicate>(__view_of<const Range>::make(r), a.pred);
+}
+
+/*******************************************************************************************/
+// transform
+
+template <class Iterator, class Function>
+class transform_iterator {
+public:
+    typedef typename iterator_traits<Iterator>::iterator_category iterator_category;
+    typedef decltype(std::declval<const Function&>()(*std::declval<Iterator>())) reference;
+    typedef typename std::decay<reference>::type                value_type;
+    typedef typename iterator_traits<Iterator>::difference_type difference_type;
+    typedef void                                                pointer;
+
+    transform_iterator() : cur(), fn(0) {}
+    transform_iterator(Iterator c, const Function *f) : cur(c), fn(f) {}
+
+    reference operator*() const { return (*fn)(*cur); }
+    reference operator[](difference_type n) const { return (*fn)(cur[n]); }
+
+    transform_iterator& operator++() { ++cur; return *this; }
+    transform_iterator& operator--() { --cur; return *this; }
+    transform_iterator operator++(int) { transform_iterator tmp = *this; ++cur; return tmp; }
+    transform_iterator operator--(int) { transform_iterator tmp = *this; --cur; return tmp; }
+    transform_iterator& operator+=(difference_type n) { cur += n; return *this; }
+    transform_iterator& operator-=(difference_type n) { cur -= n; return *this; }
+    transform_iterator operator+(difference_type n) const { return transform_iterator(cur + n, fn); }
+    transform_iterator operator-(difference_type n) const { return transform_iterator(cur - n, fn); }
+    difference_type operator-(const transform_iterator& x) const { return cur - x.cur; }
+
+    bool operator==(const transform_iterator& x) const { return cur == x.cur; }
+    bool operator!=(const transform_iterator& x) const { return cur != x.cur; }
+    bool operator<(const transform_iterator& x) const { return cur < x.cur; }
+    bool operator>(const transform_iterator& x) const { return x.cur < cur; }
+    bool operator<=(const transform_iterator& x) const { return !(x.cur < cur); }
+    bool operator>=(const transform_iterator& x) const { return !(cur < x.cur); }
+
+private:
+    Iterator cur;
+    const Function *fn;
+};
+
+template <class Range, class Function>
+class transform_view : public __view_base {
+public:
+    typedef transform_iterator<typename Range::iterator, Function> iterator;
+
+    transform_view(const Range& r, const Function& f) : base(r), fn(f) {}
+
+    iterator begin() const { return iterator(base.begin(), &fn); }
+    iterator end() const { return iterator(base.end(), &fn); }
+
+private:
+    Range base;
+    Function fn;
+};
+
+template <class Function>
+struct __transform_adaptor {
+    Function fn;
+};
+
+// 每个元素x映射为fn(x)
+template <class Function>
+inline __transform_adaptor<Function> transform(Function fn)
+{
+    __transform_adaptor<Function> a = { fn };
+    return a;
+}
+
+template <class Range, class Function>
+inline transform_view<typename __view_of<Range>::type, Function>
+operator|(Range& r, const __transform_adaptor<Function>& a)
+{
+    return transform_view<typename __view_of<Range>::type, Function>(__view_of<Range>::make(r), a.fn);
+}
+
+template <class Range, class Function>
+inline transform_view<typename __view_of<const Range>::type, Function>
+operator|(const Range& r, const __transform_adaptor<Function>& a)
+{
+    return transform_view<typename __view_of<const Range>::type, Function>(__view_of<const Range>::make(r), a.fn);
+}
+
+/*******************************************************************************************/
+// take
+
+// 带计数的迭代器：计数归零或到达底层区间的尾端时即为结束
+template <class Iterator>
+class take_iterator {
+public:
+    typedef typename __weaker_tag<forward_iterator_tag,
+                                  typename iterator_traits<Iterator>::iterator_category>::type iterator_category;
+    typedef typename iterator_traits<Iterator>::value_type        value_type;
+    typedef typename iterator_traits<Iterator>::difference_type   difference_type;
+    typedef typename iterator_traits<Iterator>::pointer           pointer;
+    typedef typename iterator_traits<Iterator>::reference         reference;
+
+    take_iterator() : cur(), last(), count(0) {}
+    take_iterator(Iterator c, Iterator l, size_t n) : cur(c), last(l), count(n) {}
+
+    reference operator*() const { return *cur; }
+
+    take_iterator& operator++()
+    {
+        ++cur;
+        --count;
+        return *this;
+    }
+
+    take_iterator operator++(int)
+    {
+        take_iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const take_iterator& x) const
+    {
+        return done() ? x.done() : (!x.done() && cur == x.cur);
+    }
+
+    bool operator!=(const take_iterator& x) const { return !(*this == x); }
+
+private:
+    Iterator cur;
+    Iterator last;
+    size_t count;
+
+    bool done() const { return 0 == count || cur == last; }
+};
+
+/**
+ * @brief 只取前n个元素
+ * 底层迭代器可随机访问时直接截取[first, first + min(n, size))，仍可随机访问；否则使用take_iterator
+ */
+template <class Range, bool = __is_random_access<typename Range::iterator>::value>
+class take_view : public __view_base {
+public:
+    typedef typename Range::iterator iterator;
+
+    take_view(const Range& r, size_t n) : base(r), count(n) {}
+
+    iterator begin() const { return base.begin(); }
+
+    iterator end() const
+    {
+        size_t n = base.end() - base.begin();
+        return base.begin() + (n < count ? n : count);
+    }
+
+private:
+    Range base;
+    size_t count;
+};
+
+template <class Range>
+class take_view<Range, false> : public __view_base {
+public:
+    typedef take_iterator<typename Range::iterator> iterator;
+
+    take_view(const Range& r, size_t n) : base(r), count(n) {}
+
+    iterator begin() const { return iterator(base.begin(), base.end(), count); }
+    iterator end() const { return iterator(base.end(), base.end(), 0); }
+
+private:
+    Range base;
+    size_t count;
+};
+
+struct __take_adaptor {
+    size_t count;
+};
+
+inline __take_adaptor take(size_t n)
+{
+    __take_adaptor a = { n };
+    return a;
+}
+
+template <class Range>
+inline take_view<typename __view_of<Range>::type>
+operator|(Range& r, const __take_adaptor& a)
+{
+    return take_view<typename __view_of<Range>::type>(__view_of<Range>::make(r), a.count);
+}
+
+template <class Range>
+inline take_view<typename __view_of<const Range>::type>
+operator|(const Range& r, const __take_adaptor& a)
+{
+    return take_view<typename __view_of<const Range>::type>(__view_of<const Range>::make(r), a.count);
+}
+
+/*******************************************************************************************/
+// zip
+
+// 同时推进两个迭代器，任一个到达尾端即结束，解引用得到两者引用组成的pair
+template <class Iterator1, class Iterator2>
+class zip_iterator {
+public:
+    typedef typename __weaker_tag<typename iterator_traits<Iterator1>::iterator_category,
+                                  typename iterator_traits<Iterator2>::iterator_category>::type iterator_category;
+    typedef std::pair<typename iterator_traits<Iterator1>::value_type,
+                      typename iterator_traits<Iterator2>::value_type> value_type;
+    typedef std::pair<typename iterator_traits<Iterator1>::reference,
+                      typename iterator_traits<Iterator2>::reference> reference;
+    typedef ptrdiff_t   difference_type;
+    typedef void        pointer;
+
+    zip_iterator() : it1(), it2() {}
+    zip_iterator(Iterator1 i1, Iterator2 i2) : it1(i1), it2(i2) {}
+
+    reference operator*() const { return reference(*it1, *it2); }
+    reference operator[](difference_type n) const { return reference(it1[n], it2[n]); }
+
+    zip_iterator& operator++() { ++it1; ++it2; return *this; }
+    zip_iterator& operator--() { --it1; --it2; return *this; }
+    zip_iterator operator++(int) { zip_iterator tmp = *this; ++*this; return tmp; }
+    zip_iterator operator--(int) { zip_iterator tmp = *this; --*this; return tmp; }
+    zip_iterator& operator+=(difference_type n) { it1 += n; it2 += n; return *this; }
+    zip_iterator& operator-=(difference_type n) { it1 -= n; it2 -= n; return *this; }
+    zip_iterator operator+(difference_type n) const { return zip_iterator(it1 + n, it2 + n); }
+    zip_iterator operator-(difference_type n) const { return zip_iterator(it1 - n, it2 - n); }
+
+    // 取两者中较短的距离，end() - begin()即为较短区间的长度
+    difference_type operator-(const zip_iterator& x) const
+    {
+        difference_type d1 = it1 - x.it1;
+        difference_type d2 = it2 - x.it2;
+        return d1 < d2 ? d1 : d2;
+    }
+
+    bool operator==(const zip_iterator& x) const { return it1 == x.it1 || it2 == x.it2; }
+    bool operator!=(const zip_iterator& x) const { return !(*this == x); }
+    bool operator<(const zip_iterator& x) const { return it1 < x.it1 && it2 < x.it2; }
+    bool operator>(const zip_iterator& x) const { return x < *this; }
+    bool operator<=(const zip_iterator& x) const { return !(x < *this); }
+    bool operator>=(const zip_iterator& x) const { return !(*this < x); }
+
+private:
+    Iterator1 it1;
+    Iterator2 it2;
+};
+
+template <class Range1, class Range2>
+class zip_view : public __view_base {
+public:
+    typedef zip_iterator<typename Range1::iterator, typename Range2::iterator> iterator;
+
+    zip_view(const Range1& r1, const Range2& r2) : base1(r1), base2(r2) {}
+
+    iterator begin() const { return iterator(base1.begin(), base2.begin()); }
+    iterator end() const { return iterator(base1.end(), base2.end()); }
+
+private:
+    Range1 base1;
+    Range2 base2;
+};
+
+template <class Range1, class Range2>
+inline zip_view<typename __view_of<Range1>::type, typename __view_of<Range2>::type>
+zip(Range1& r1, Range2& r2)
+{
+    return zip_view<typename __view_of<Range1>::type, typename __view_of<Range2>::type>(
+        __view_of<Range1>::make(r1), __view_of<Range2>::make(r2));
+}
+
+template <class Range1, class Range2>
+inline zip_view<typename __view_of<const Range1>::type, typename __view_of<const Range2>::type>
+zip(const Range1& r1, const Range2& r2)
+{
+    return zip_view<typename __view_of<const Range1>::type, typename __view_of<const Range2>::type>(
+        __view_of<const Range1>::make(r1), __view_of<const Range2>::make(r2));
+}
+
+/*******************************************************************************************/
+// chunk
+
+// 每次解引用得到接下来至多n个元素组成的iterator_range
+template <class Iterator>
+class chunk_iterator {
+public:
+    typedef typename __weaker_tag<forward_iterator_tag,
+                                  typename iterator_traits<Iterator>::iterator_category>::type iterator_category;
+    typedef iterator_range<Iterator>    value_type;
+    typedef value_type                  reference;
+    typedef ptrdiff_t                   difference_type;
+    typedef void                        pointer;
+
+    chunk_iterator() : cur(), last(), n(1) {}
+    chunk_iterator(Iterator c, Iterator l, size_t size) : cur(c), last(l), n(size) {}
+
+    reference operator*() const { return reference(cur, next()); }
+
+    chunk_iterator& operator++()
+    {
+        cur = next();
+        return *this;
+    }
+
+    chunk_iterator operator++(int)
+    {
+        chunk_iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const chunk_iterator& x) const { return cur == x.cur; }
+    bool operator!=(const chunk_iterator& x) const { return cur != x.cur; }
+
+private:
+    Iterator cur;
+    Iterator last;
+    size_t n;
+
+    Iterator next() const
+    {
+        return __next(cur, typename iterator_traits<Iterator>::iterator_category());
+    }
+
+    Iterator __next(Iterator it, random_access_iterator_tag) const
+    {
+        size_t left = last - it;
+        return it + (left < n ? left : n);
+    }
+
+    Iterator __next(Iterator it, input_iterator_tag) const
+    {
+        for (size_t i = 0; i < n && it != last; ++i) {
+            ++it;
+        }
+        return it;
+    }
+};
+
+template <class Range>
+class chunk_view : public __view_base {
+public:
+    typedef chunk_iterator<typename Range::iterator> iterator;
+
+    chunk_view(const Range& r, size_t size) : base(r), n(size ? size : 1) {}
+
+    iterator begin() const { return iterator(base.begin(), base.end(), n); }
+    iterator end() const { return iterator(base.end(), base.end(), n); }
+
+private:
+    Range base;
+    size_t n;
+};
+
+struct __chunk_adaptor {
+    size_t size;
+};
+
+// 切成每块n个元素（最后一块可能不足n个）
+inline __chunk_adaptor chunk(size_t n)
+{
+    __chunk_adaptor a = { n };
+    return a;
+}
+
+template <class Range>
+inline chunk_view<typename __view_of<Range>::type>
+operator|(Range& r, const __chunk_adaptor& a)
+{
+    return chunk_view<typename __view_of<Range>::type>(__view_of<Range>::make(r), a.size);
+}
+
+template <class Range>
+inline chunk_view<typename __view_of<const Range>::type>
+operator|(const Range& r, const __chunk_adaptor& a)
+{
+    return chunk_view<typename __view_of<const Range>::type>(__view_of<const Range>::make(r), a.size);
+}
+
+/*******************************************************************************************/
+// to_vector
+
+template <class InputIterator, class T, class Alloc>
+inline void __to_vector(InputIterator first, InputIterator last, Vector<T, Alloc>& result, input_iterator_tag)
+{
+    for (; first != last; ++first) {
+        result.push_back(*first);
+    }
+}
+
+// 视图保持长度可算时，先一次配置好全部空间
+template <class RandomAccessIterator, class T, class Alloc>
+inline void __to_vector(RandomAccessIterator first, RandomAccessIterator last, Vector<T, Alloc>& result,
+                        random_access_iterator_tag)
+{
+    result.reserve(result.size() + (last - first));
+    for (; first != last; ++first) {
+        result.push_back(*first);
+    }
+}
+
+/**
+ * @brief 终结操作：遍历视图一次，把结果追加到result
+ */
+template <class Range, class T, class Alloc>
+inline void to_vector(const Range& r, Vector<T, Alloc>& result)
+{
+    typedef typename Range::iterator iterator;
+    __to_vector(r.begin(), r.end(), result, typename iterator_traits<iterator>::iterator_category());
+}
+
+}
+
+#endif
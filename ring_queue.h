@@ -0,0 +1,346 @@
+#ifndef MYSTL_RING_QUEUE_H_
+#define MYSTL_RING_QUEUE_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "alloc.h"
+#include "construct.h"
+#include "util.h"
+
+/**
+ * @brief 有界无锁环形队列
+ * mpmc_queue：多生产者多消费者，采用Vyukov的做法，每个槽位带一个序号（sequence），
+ *   生产者/消费者以CAS推进各自的位置，再凭序号判断槽位是否可写/可读，无需互斥锁。
+ * spsc_queue：单生产者单消费者特化版，只需load/store，不需要CAS。
+ * 两者的容量均上调为2的幂，以位与代替取模；生产端与消费端的位置各占一条cache line，避免伪共享。
+ * 槽位空间由Alloc配置，元素以construct()/destroy()构造和析构，因此可以存放非POD对象。
+ */
+
+namespace mystl {
+
+enum {__CACHE_LINE = 64};
+
+template <class T, class Alloc = mystl::alloc>
+class mpmc_queue {
+public:
+    typedef T           value_type;
+    typedef size_t      size_type;
+
+private:
+    struct cell {
+        std::atomic<size_type> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T *data() { return (T *)&storage; }
+    };
+
+    typedef mystl::simple_alloc<cell, Alloc> cell_allocator;
+
+    cell *buffer;
+    size_type mask;
+    alignas(__CACHE_LINE) std::atomic<size_type> enqueue_pos;
+    alignas(__CACHE_LINE) std::atomic<size_type> dequeue_pos;
+
+    mpmc_queue(const mpmc_queue&);
+    mpmc_queue& operator=(const mpmc_queue&);
+
+public:
+    // 容量上调为2的幂，且至少为2：只有一个槽位时，“已满”与“可写”两种状态的序号相同，无法区分
+    explicit mpmc_queue(size_type capacity)
+    {
+        size_type n = __ring_round_up(capacity < 2 ? 2 : capacity);
+        buffer = cell_allocator::allocate(n);
+        mask = n - 1;
+        for (size_type i = 0; i < n; ++i) {
+            new (&buffer[i].sequence) std::atomic<size_type>(i);
+        }
+        enqueue_pos.store(0, std::memory_order_relaxed);
+        dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    // 析构时不得再有并发访问
+    ~mpmc_queue()
+    {
+        size_type last = enqueue_pos.load(std::memory_order_relaxed);
+        for (size_type pos = dequeue_pos.load(std::memory_order_relaxed); pos != last; ++pos) {
+            mystl::destroy(buffer[pos & mask].data());
+        }
+        cell_allocator::deallocate(buffer, mask + 1);
+    }
+
+    size_type capacity() const
+    {
+        return mask + 1;
+    }
+
+    /**
+     * @brief 尝试入队
+     * 占到槽位之后的构造不能抛出异常：否则该槽位的序号永远不会推进，队列随之卡死。
+     * 因此T的复制可能抛出异常时，先在占用槽位之前复制出临时对象，占到槽位后再以不抛异常的移动构造放入；
+     * 这要求T的移动构造函数为noexcept。
+     * @return bool 队列已满时返回false
+     */
+    bool try_push(const T& x)
+    {
+        return push(x, std::integral_constant<bool, std::is_nothrow_copy_constructible<T>::value>());
+    }
+
+    /**
+     * @brief 尝试出队
+     * 若对x的移动赋值抛出异常，该元素被丢弃，槽位照常释放，异常继续向外传递
+     * @return bool 队列为空时返回false
+     */
+    bool try_pop(T& x)
+    {
+        return 1 == try_pop_n(&x, 1);
+    }
+
+    /**
+     * @brief 批量入队[first, first + n)
+     * 先数出从enqueue_pos起连续可写的槽位，以一次CAS占下整批，再依次构造并发布。
+     * T的复制可能抛出异常时，退回逐个try_push()
+     * @return size_type 实际入队的个数
+     */
+    template <class InputIterator>
+    size_type try_push_n(InputIterator first, size_type n)
+    {
+        return push_n(first, n, std::integral_constant<bool, std::is_nothrow_copy_constructible<T>::value>());
+    }
+
+    /**
+     * @brief 批量出队至多n个元素到result
+     * 与try_push_n()相同，以一次CAS占下连续可读的槽位
+     * @return size_type 实际出队的个数
+     */
+    template <class OutputIterator>
+    size_type try_pop_n(OutputIterator result, size_type n)
+    {
+        size_type pos;
+        size_type k = claim(dequeue_pos, n, 1, pos);
+        size_type i = 0;
+        try {
+            for (; i < k; ++i, ++result) {
+                T *p = buffer[(pos + i) & mask].data();
+                *result = std::move(*p);
+                release_read(pos + i);
+            }
+        } catch (...) {
+            // 出错的元素和其后已占下的元素都丢弃，槽位必须全部归还
+            for (; i < k; ++i) {
+                release_read(pos + i);
+            }
+            throw;
+        }
+        return k;
+    }
+
+private:
+    /**
+     * @brief 以一次CAS占下从pos_ref起至多n个连续的槽位
+     * 槽位pos可占用的条件是其序号等于pos + lag（入队lag为0，出队lag为1）；
+     * 条件一旦成立，在pos_ref越过该槽位之前不会改变，因此先数后CAS是安全的
+     * @return size_type 占下的个数，起点存入pos
+     */
+    size_type claim(std::atomic<size_type>& pos_ref, size_type n, size_type lag, size_type& pos)
+    {
+        pos = pos_ref.load(std::memory_order_relaxed);
+        for (;;) {
+            size_type k = 0;
+            ptrdiff_t dif = 0;
+            for (; k < n; ++k) {
+                size_type seq = buffer[(pos + k) & mask].sequence.load(std::memory_order_acquire);
+                dif = (ptrdiff_t)seq - (ptrdiff_t)(pos + k + lag);
+                if (0 != dif) {
+                    break;
+                }
+            }
+            if (k > 0) {
+                if (pos_ref.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                    return k;
+                }
+            } else if (dif < 0 || 0 == n) {
+                return 0; // 已满（入队）或为空（出队）
+            } else {
+                pos = pos_ref.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 在已占下的槽位pos上构造元素并交给消费者，U的构造不得抛出异常
+    template <class U>
+    void publish(size_type pos, U&& x)
+    {
+        cell *c = &buffer[pos & mask];
+        new (c->data()) T(std::forward<U>(x));
+        c->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    // 析构已读出的元素，把槽位交还给下一轮的生产者
+    void release_read(size_type pos)
+    {
+        cell *c = &buffer[pos & mask];
+        mystl::destroy(c->data());
+        c->sequence.store(pos + mask + 1, std::memory_order_release);
+    }
+
+    bool push(const T& x, std::true_type)
+    {
+        size_type pos;
+        if (0 == claim(enqueue_pos, 1, 0, pos)) {
+            return false;
+        }
+        publish(pos, x);
+        return true;
+    }
+
+    bool push(const T& x, std::false_type)
+    {
+        static_assert(std::is_nothrow_move_constructible<T>::value,
+                      "mpmc_queue requires T to be nothrow copy or move constructible");
+        T tmp(x);
+        size_type pos;
+        if (0 == claim(enqueue_pos, 1, 0, pos)) {
+            return false;
+        }
+        publish(pos, std::move(tmp));
+        return true;
+    }
+
+    template <class InputIterator>
+    size_type push_n(InputIterator first, size_type n, std::true_type)
+    {
+        size_type pos;
+        size_type k = claim(enqueue_pos, n, 0, pos);
+        for (size_type i = 0; i < k; ++i, ++first) {
+            publish(pos + i, *first);
+        }
+        return k;
+    }
+
+    template <class InputIterator>
+    size_type push_n(InputIterator first, size_type n, std::false_type)
+    {
+        size_type i = 0;
+        for (; i < n && try_push(*first); ++i, ++first) {}
+        return i;
+    }
+};
+
+template <class T, class Alloc = mystl::alloc>
+class spsc_queue {
+public:
+    typedef T           value_type;
+    typedef size_t      size_type;
+
+private:
+    typedef mystl::simple_alloc<T, Alloc> data_allocator;
+
+    T *buffer;
+    size_type mask;
+
+    // 生产端：tail由生产者写，cached_head是生产者对head的本地快照
+    alignas(__CACHE_LINE) std::atomic<size_type> tail;
+    size_type cached_head;
+    // 消费端：head由消费者写，cached_tail是消费者对tail的本地快照
+    alignas(__CACHE_LINE) std::atomic<size_type> head;
+    size_type cached_tail;
+
+    spsc_queue(const spsc_queue&);
+    spsc_queue& operator=(const spsc_queue&);
+
+public:
+    explicit spsc_queue(size_type capacity) : cached_head(0), cached_tail(0)
+    {
+        size_type n = __ring_round_up(capacity);
+        buffer = data_allocator::allocate(n);
+        mask = n - 1;
+        tail.store(0, std::memory_order_relaxed);
+        head.store(0, std::memory_order_relaxed);
+    }
+
+    ~spsc_queue()
+    {
+        size_type t = tail.load(std::memory_order_relaxed);
+        for (size_type h = head.load(std::memory_order_relaxed); h != t; ++h) {
+            mystl::destroy(&buffer[h & mask]);
+        }
+        data_allocator::deallocate(buffer, mask + 1);
+    }
+
+    size_type capacity() const
+    {
+        return mask + 1;
+    }
+
+    // 仅供生产者调用
+    bool try_push(const T& x)
+    {
+        return 1 == try_push_n(&x, 1);
+    }
+
+    // 仅供消费者调用
+    bool try_pop(T& x)
+    {
+        return 1 == try_pop_n(&x, 1);
+    }
+
+    /**
+     * @brief 批量入队，仅供生产者调用
+     * 先构造所有能放下的元素，再以一次release store发布，消费者一次即可看到整批
+     * @return size_type 实际入队的个数
+     */
+    template <class InputIterator>
+    size_type try_push_n(InputIterator first, size_type n)
+    {
+        size_type t = tail.load(std::memory_order_relaxed);
+        size_type room = mask + 1 - (t - cached_head);
+        if (room < n) {
+            cached_head = head.load(std::memory_order_acquire);
+            room = mask + 1 - (t - cached_head);
+        }
+        if (n > room) {
+            n = room;
+        }
+        for (size_type i = 0; i < n; ++i, ++first) {
+            mystl::construct(&buffer[(t + i) & mask], *first);
+        }
+        if (n) {
+            tail.store(t + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    /**
+     * @brief 批量出队，仅供消费者调用
+     * @return size_type 实际出队的个数
+     */
+    template <class OutputIterator>
+    size_type try_pop_n(OutputIterator result, size_type n)
+    {
+        size_type h = head.load(std::memory_order_relaxed);
+        size_type avail = cached_tail - h;
+        if (avail < n) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            avail = cached_tail - h;
+        }
+        if (n > avail) {
+            n = avail;
+        }
+        for (size_type i = 0; i < n; ++i, ++result) {
+            T *p = &buffer[(h + i) & mask];
+            *result = std::move(*p);
+            mystl::destroy(p);
+        }
+        if (n) {
+            head.store(h + n, std::memory_order_release);
+        }
+        return n;
+    }
+};
+
+}
+
+#endif
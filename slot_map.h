@@ -0,0 +1,211 @@
+#ifndef MYSTL_SLOT_MAP_H_
+#define MYSTL_SLOT_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "alloc.h"
+#include "vector.h"
+
+/**
+ * @brief 带世代号的slot_map
+ * 元素紧密地存放在一个Vector中，遍历即扫描一段连续空间；客端持有的是64位的句柄(index, generation)而非指针。
+ * index指向slots表中的一格，该格记录元素目前在紧密数组中的位置，以及该格的世代号。
+ * 删除元素时把最后一个元素搬到空位上（swap-remove），并把该格的世代号加一，旧句柄从此失效；
+ * 世代号为奇数表示该格使用中，偶数表示空闲，因此指向空闲格的句柄不论世代号为何都无效。
+ * 空出的格串成free list，供之后的插入复用。插入、删除、查找都是O(1)。
+ */
+
+namespace mystl {
+
+struct slot_handle {
+    uint32_t index;
+    uint32_t generation;
+
+    slot_handle() : index(uint32_t(-1)), generation(0) {}
+    slot_handle(uint32_t i, uint32_t g) : index(i), generation(g) {}
+
+    // 与64位整数互相转换，便于存放在别处
+    uint64_t value() const
+    {
+        return (uint64_t(generation) << 32) | index;
+    }
+
+    static slot_handle from_value(uint64_t v)
+    {
+        return slot_handle(uint32_t(v), uint32_t(v >> 32));
+    }
+
+    bool operator==(const slot_handle& x) const { return index == x.index && generation == x.generation; }
+    bool operator!=(const slot_handle& x) const { return !(*this == x); }
+};
+
+/**
+ * @brief 带世代号的格表，slot_map与indexed_dary_heap共用
+ * 使用中的格记录其元素目前的位置，空闲的格以同一字段串成free list；
+ * 世代号为奇数表示使用中、偶数表示空闲，acquire()与release()各加一。
+ */
+template <class Alloc>
+class __slot_table {
+public:
+    struct slot {
+        uint32_t pos;           // 使用中：元素的位置；空闲：下一个空闲格
+        uint32_t generation;
+    };
+
+    __slot_table() : free_head(__NO_SLOT) {}
+
+    void reserve(size_t n)
+    {
+        slots.reserve(n);
+    }
+
+    // 第s格所指元素的位置，元素搬移后由容器更新
+    uint32_t& pos(uint32_t s) { return slots[s].pos; }
+    uint32_t pos(uint32_t s) const { return slots[s].pos; }
+
+    slot *data() { return slots.begin(); }
+
+    slot_handle handle_of(uint32_t s) const
+    {
+        return slot_handle(s, slots[s].generation);
+    }
+
+    bool contains(slot_handle h) const
+    {
+        return h.index < slots.size() && slots[h.index].generation == h.generation
+            && (h.generation & 1);
+    }
+
+    // 取一个空闲格（没有时新增一格），调用者随后须设定pos
+    uint32_t acquire()
+    {
+        uint32_t s = free_head;
+        if (s == __NO_SLOT) {
+            slot fresh = { 0, 1 };
+            s = uint32_t(slots.size());
+            slots.push_back(fresh);
+        } else {
+            free_head = slots[s].pos;
+            ++slots[s].generation; // 变回奇数
+        }
+        return s;
+    }
+
+    void release(uint32_t s)
+    {
+        ++slots[s].generation; // 变为偶数，指向此格的句柄都失效
+        slots[s].pos = free_head;
+        free_head = s;
+    }
+
+private:
+    enum {__NO_SLOT = 0xffffffffu};
+
+    Vector<slot, Alloc> slots;
+    uint32_t free_head;                 // 空闲格组成的链表
+};
+
+template <class T, class Alloc = mystl::alloc>
+class slot_map {
+public:
+    typedef T               value_type;
+    typedef T*              iterator;
+    typedef const T*        const_iterator;
+    typedef T&              reference;
+    typedef size_t          size_type;
+    typedef slot_handle     handle;
+
+protected:
+    Vector<T, Alloc> values;            // 紧密存放的元素
+    Vector<uint32_t, Alloc> owners;     // owners[i]为values[i]所属的格
+    __slot_table<Alloc> slots;          // 每格记录元素在values中的位置
+
+public:
+    slot_map() {}
+
+    iterator begin() { return values.begin(); }
+    iterator end() { return values.end(); }
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end() const { return values.end(); }
+
+    size_type size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+
+    void reserve(size_type n)
+    {
+        values.reserve(n);
+        owners.reserve(n);
+        slots.reserve(n);
+    }
+
+    // 插入x，返回指向它的句柄
+    handle insert(const T& x)
+    {
+        uint32_t s = slots.acquire();
+        slots.pos(s) = uint32_t(values.size());
+        values.push_back(x);
+        owners.push_back(s);
+        return slots.handle_of(s);
+    }
+
+    bool contains(handle h) const
+    {
+        return slots.contains(h);
+    }
+
+    // 句柄有效时返回元素地址，否则返回0。地址在下一次erase之前有效
+    T *get(handle h)
+    {
+        return contains(h) ? &values[slots.pos(h.index)] : 0;
+    }
+
+    const T *get(handle h) const
+    {
+        return contains(h) ? &values[slots.pos(h.index)] : 0;
+    }
+
+    // 不检查句柄
+    reference operator[](handle h)
+    {
+        return values[slots.pos(h.index)];
+    }
+
+    // 删除句柄所指的元素，句柄无效时返回false
+    bool erase(handle h)
+    {
+        if (!contains(h)) {
+            return false;
+        }
+        uint32_t pos = slots.pos(h.index);
+        uint32_t last = uint32_t(values.size() - 1);
+        if (pos != last) {
+            values[pos] = values[last];
+            owners[pos] = owners[last];
+            slots.pos(owners[pos]) = pos;
+        }
+        values.pop_back();
+        owners.pop_back();
+        slots.release(h.index);
+        return true;
+    }
+
+    // 删除所有元素，所有句柄都失效，格保留下来供复用
+    void clear()
+    {
+        for (size_type i = 0; i < owners.size(); ++i) {
+            slots.release(owners[i]);
+        }
+        values.clear();
+        owners.clear();
+    }
+
+    // 紧密数组中第i个元素的句柄，可在遍历时取得
+    handle handle_at(size_type i) const
+    {
+        return slots.handle_of(owners[i]);
+    }
+};
+
+}
+
+#endif
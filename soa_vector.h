@@ -0,0 +1,345 @@
+#ifndef MYSTL_SOA_VECTOR_H_
+#define MYSTL_SOA_VECTOR_H_
+
+#include <stddef.h>
+#include <string.h>
+#include <new>
+#include <tuple>
+#include <utility>
+#include "alloc.h"
+#include "construct.h"
+#include "iterator.h"
+#include "type_traits.h"
+#include "util.h"
+
+/**
+ * @brief 结构数组容器 soa_vector<Ts...>
+ * 与Vector<Record>把整条记录连续存放（array of structs）不同，soa_vector把每个字段各自存放在一段连续数组中
+ * （structure of arrays）。所有字段共用同一次配置：一块内存被切成sizeof...(Ts)段，每段按cache line对齐。
+ * 只扫描一两个字段时，读入cache的全是有用数据，编译器也容易对column()返回的连续区间做向量化。
+ * 扩容时若搬迁某个元素抛出异常，新空间被释放，原有内容保持不变。
+ */
+
+namespace mystl {
+
+enum {__SOA_ALIGN = 64}; // 每一列的起始位置按cache line对齐
+
+template <class Alloc, class... Ts>
+class basic_soa_vector {
+public:
+    typedef std::tuple<Ts...>   value_type;
+    typedef std::tuple<Ts&...>  reference;  // 代理引用：各列中同一行元素的引用
+    typedef size_t              size_type;
+    typedef ptrdiff_t           difference_type;
+
+    enum {column_count = sizeof...(Ts)};
+
+    template <size_t I>
+    struct column_type {
+        typedef typename std::tuple_element<I, std::tuple<Ts...> >::type type;
+    };
+
+    class iterator {
+    public:
+        typedef random_access_iterator_tag          iterator_category;
+        typedef typename basic_soa_vector::value_type value_type;
+        typedef ptrdiff_t                           difference_type;
+        typedef void                                pointer; // 代理迭代器没有真正的指针
+        typedef typename basic_soa_vector::reference reference;
+
+        iterator() : v(0), i(0) {}
+        iterator(basic_soa_vector *vec, size_type idx) : v(vec), i(idx) {}
+
+        reference operator*() const { return (*v)[i]; }
+        reference operator[](difference_type n) const { return (*v)[i + n]; }
+
+        iterator& operator++() { ++i; return *this; }
+        iterator& operator--() { --i; return *this; }
+        iterator operator++(int) { iterator tmp = *this; ++i; return tmp; }
+        iterator operator--(int) { iterator tmp = *this; --i; return tmp; }
+        iterator& operator+=(difference_type n) { i += n; return *this; }
+        iterator& operator-=(difference_type n) { i -= n; return *this; }
+        iterator operator+(difference_type n) const { return iterator(v, i + n); }
+        iterator operator-(difference_type n) const { return iterator(v, i - n); }
+        difference_type operator-(const iterator& x) const { return difference_type(i) - difference_type(x.i); }
+
+        bool operator==(const iterator& x) const { return i == x.i; }
+        bool operator!=(const iterator& x) const { return i != x.i; }
+        bool operator<(const iterator& x) const { return i < x.i; }
+        bool operator>(const iterator& x) const { return i > x.i; }
+        bool operator<=(const iterator& x) const { return i <= x.i; }
+        bool operator>=(const iterator& x) const { return i >= x.i; }
+
+        size_type index() const { return i; }
+
+    private:
+        basic_soa_vector *v;
+        size_type i;
+    };
+
+protected:
+    typedef std::index_sequence_for<Ts...> indices;
+
+    char *storage;                  // 配置所得的原始内存
+    size_type storage_bytes;
+    std::tuple<Ts*...> columns;     // 各列的起始位置
+    size_type len;
+    size_type cap;
+
+public:
+    basic_soa_vector() : storage(0), storage_bytes(0), len(0), cap(0) {}
+
+    explicit basic_soa_vector(size_type n) : storage(0), storage_bytes(0), len(0), cap(0)
+    {
+        resize(n);
+    }
+
+    ~basic_soa_vector()
+    {
+        clear();
+        deallocate();
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, len); }
+
+    size_type size() const { return len; }
+    size_type capacity() const { return cap; }
+    bool empty() const { return 0 == len; }
+
+    reference operator[](size_type n)
+    {
+        return row(n, indices());
+    }
+
+    reference front() { return (*this)[0]; }
+    reference back() { return (*this)[len - 1]; }
+
+    // 第I列的起始位置
+    template <size_t I>
+    typename column_type<I>::type *data()
+    {
+        return std::get<I>(columns);
+    }
+
+    // 第I列的连续视图，适合只扫描单个字段的循环
+    template <size_t I>
+    column_span<typename column_type<I>::type> column()
+    {
+        column_span<typename column_type<I>::type> s = { std::get<I>(columns), len };
+        return s;
+    }
+
+    void push_back(const Ts&... values)
+    {
+        if (len == cap) {
+            reallocate(cap ? 2 * cap : 8);
+        }
+        construct_row(len, indices(), values...);
+        ++len;
+    }
+
+    void pop_back()
+    {
+        --len;
+        destroy_row(len, indices());
+    }
+
+    void reserve(size_type n)
+    {
+        if (n > cap) {
+            reallocate(n);
+        }
+    }
+
+    /**
+     * @brief 改变行数
+     * 缩小时析构尾部各行，扩大时以各列的默认值填充，因此要求每个Ts都可以默认构造
+     */
+    void resize(size_type n)
+    {
+        if (n > cap) {
+            reallocate(n > 2 * cap ? n : 2 * cap);
+        }
+        while (len > n) {
+            pop_back();
+        }
+        for (; len < n; ++len) {
+            construct_row(len, indices(), Ts()...);
+        }
+    }
+
+    void clear()
+    {
+        destroy_columns(0, len, indices());
+        len = 0;
+    }
+
+private:
+    basic_soa_vector(const basic_soa_vector&);
+    basic_soa_vector& operator=(const basic_soa_vector&);
+
+    static size_type ROUND_UP(size_type bytes)
+    {
+        return (bytes + __SOA_ALIGN - 1) & ~(size_type)(__SOA_ALIGN - 1);
+    }
+
+    // 依次计算各列在容量为n时的偏移，返回所需的总字节数
+    static size_type layout(size_type n, size_type *offsets)
+    {
+        const size_type sizes[] = { sizeof(Ts)... };
+        size_type total = 0;
+        for (size_type k = 0; k < sizeof...(Ts); ++k) {
+            offsets[k] = total;
+            total += ROUND_UP(sizes[k] * n);
+        }
+        return total;
+    }
+
+    void deallocate()
+    {
+        if (storage) {
+            Alloc::deallocate(storage, storage_bytes);
+        }
+    }
+
+    template <size_t... I>
+    reference row(size_type n, std::index_sequence<I...>)
+    {
+        return reference(std::get<I>(columns)[n]...);
+    }
+
+    // 逐列构造第n行；某一列抛出异常时析构已构造的各列
+    template <size_t... I>
+    void construct_row(size_type n, std::index_sequence<I...>, const Ts&... values)
+    {
+        size_type done = 0;
+        try {
+            int dummy[] = { 0, (mystl::construct(std::get<I>(columns) + n, values), ++done, 0)... };
+            (void)dummy;
+        } catch (...) {
+            destroy_leading_columns(columns, done, n, n + 1, indices());
+            throw;
+        }
+    }
+
+    template <size_t... I>
+    void destroy_row(size_type n, std::index_sequence<I...>)
+    {
+        destroy_columns(n, n + 1, std::index_sequence<I...>());
+    }
+
+    template <size_t... I>
+    void destroy_columns(size_type first, size_type last, std::index_sequence<I...>)
+    {
+        int dummy[] = { 0, (destroy_range(std::get<I>(columns) + first, std::get<I>(columns) + last), 0)... };
+        (void)dummy;
+    }
+
+    // 析构cols中前ncols列的[first, last)，用于构造到一半抛出异常时的回滚
+    template <size_t... I>
+    static void destroy_leading_columns(const std::tuple<Ts*...>& cols, size_type ncols,
+                                        size_type first, size_type last, std::index_sequence<I...>)
+    {
+        int dummy[] = { 0, (I < ncols ? destroy_range(std::get<I>(cols) + first, std::get<I>(cols) + last) : (void)0, 0)... };
+        (void)dummy;
+    }
+
+    template <class T>
+    static void destroy_range(T *first, T *last)
+    {
+        typedef typename __type_traits<T>::has_trivial_destructor trivial_destructor;
+        __destroy_range(first, last, trivial_destructor());
+    }
+
+    template <class T>
+    static void __destroy_range(T *, T *, __true_type) {}
+
+    template <class T>
+    static void __destroy_range(T *first, T *last, __false_type)
+    {
+        for (; first < last; ++first) {
+            mystl::destroy(first);
+        }
+    }
+
+    /**
+     * @brief 把一列元素搬到新空间，旧元素留待全部搬完后再析构
+     * POD型别整块memcpy；否则移动构造不会抛出异常时移动，会抛出时复制，
+     * 中途抛出异常则析构已构造的新元素，旧元素不受影响
+     */
+    template <class T>
+    static void relocate(T *first, T *last, T *result)
+    {
+        typedef typename __type_traits<T>::is_POD_type is_POD;
+        __relocate(first, last, result, is_POD());
+    }
+
+    template <class T>
+    static void __relocate(T *first, T *last, T *result, __true_type)
+    {
+        if (last != first) {
+            memcpy(result, first, sizeof(T) * (last - first));
+        }
+    }
+
+    template <class T>
+    static void __relocate(T *first, T *last, T *result, __false_type)
+    {
+        T *cur = result;
+        try {
+            for (; first != last; ++first, ++cur) {
+                new (cur) T(std::move_if_noexcept(*first));
+            }
+        } catch (...) {
+            __destroy_range(result, cur, __false_type());
+            throw;
+        }
+    }
+
+    // 依次搬迁各列，done记录已完整搬迁的列数
+    template <size_t... I>
+    void relocate_columns(const std::tuple<Ts*...>& to, size_type& done, std::index_sequence<I...>)
+    {
+        int dummy[] = { 0, (relocate(std::get<I>(columns), std::get<I>(columns) + len, std::get<I>(to)), ++done, 0)... };
+        (void)dummy;
+    }
+
+    template <size_t... I>
+    static std::tuple<Ts*...> make_columns(char *base, const size_type *offsets, std::index_sequence<I...>)
+    {
+        return std::tuple<Ts*...>((Ts *)(base + offsets[I])...);
+    }
+
+    // 所有列一起扩容：一次配置，各列依次搬迁，全部成功后才析构旧元素并释放旧空间
+    void reallocate(size_type n)
+    {
+        size_type offsets[sizeof...(Ts)];
+        size_type bytes = layout(n, offsets) + __SOA_ALIGN;
+        char *raw = (char *)Alloc::allocate(bytes);
+        char *base = (char *)ROUND_UP((size_type)raw);
+        std::tuple<Ts*...> to = make_columns(base, offsets, indices());
+
+        size_type done = 0;
+        try {
+            relocate_columns(to, done, indices());
+        } catch (...) {
+            destroy_leading_columns(to, done, 0, len, indices());
+            Alloc::deallocate(raw, bytes);
+            throw;
+        }
+        destroy_columns(0, len, indices());
+        deallocate();
+        storage = raw;
+        storage_bytes = bytes;
+        columns = to;
+        cap = n;
+    }
+};
+
+template <class... Ts>
+using soa_vector = basic_soa_vector<mystl::alloc, Ts...>;
+
+}
+
+#endif
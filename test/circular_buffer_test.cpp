@@ -0,0 +1,85 @@
+#include <assert.h>
+#include <stddef.h>
+#include "circular_buffer.h"
+
+// 两段区间依次连起来，应与按下标访问的顺序相同
+template <class Buffer>
+static void check_spans(const Buffer& b)
+{
+    mystl::column_span<const int> one = b.array_one();
+    mystl::column_span<const int> two = b.array_two();
+    assert(one.size() + two.size() == b.size());
+    for (size_t i = 0; i < one.size(); ++i) {
+        assert(one[i] == b[i]);
+    }
+    for (size_t i = 0; i < two.size(); ++i) {
+        assert(two[i] == b[one.size() + i]);
+    }
+}
+
+int main()
+{
+    // 容量上调为2的幂，1仍为1
+    assert(8 == mystl::circular_buffer<int>(5).capacity());
+    assert(1 == mystl::circular_buffer<int>(1).capacity());
+
+    // overwrite_oldest：写满后保留最近的capacity()个，跨过空间末尾时分成两段
+    mystl::circular_buffer<int> w(8);
+    for (int i = 0; i < 8; ++i) {
+        assert(w.push_back(i));
+    }
+    assert(w.full() && 0 == w.front() && 7 == w.back());
+    check_spans(w);
+    assert(0 == w.array_two().size());
+
+    for (int i = 8; i < 13; ++i) {
+        assert(w.push_back(i));
+    }
+    assert(8 == w.size() && 5 == w.front() && 12 == w.back());
+    assert(3 == w.array_one().size() && 5 == w.array_two().size());
+    check_spans(w);
+    int expect = 5;
+    for (mystl::circular_buffer<int>::iterator it = w.begin(); it != w.end(); ++it) {
+        assert(expect++ == *it);
+    }
+    assert(8 == w.end() - w.begin() && w.begin() < w.end());
+
+    // 头端移除后从空间中部开始，再加入时绕回开头
+    w.pop_front();
+    w.pop_front();
+    w.pop_back();
+    assert(5 == w.size() && 7 == w.front() && 11 == w.back());
+    check_spans(w);
+    w.push_back(20);
+    w.push_back(21);
+    assert(7 == w.size() && 21 == w.back() && 7 == w[0]);
+    check_spans(w);
+
+    // 副本保持相同的顺序
+    mystl::circular_buffer<int> copy(w);
+    assert(copy.size() == w.size());
+    for (size_t i = 0; i < w.size(); ++i) {
+        assert(copy[i] == w[i]);
+    }
+
+    // reject_when_full：满时拒绝，不覆盖最旧的元素
+    mystl::circular_buffer<int> r(4, mystl::reject_when_full);
+    for (int i = 0; i < 4; ++i) {
+        assert(r.push_back(i));
+    }
+    assert(!r.push_back(99) && 0 == r.front() && 3 == r.back());
+    r.pop_front();
+    assert(r.push_back(4) && 1 == r.front() && 4 == r.back());
+    assert(3 == r.array_one().size() && 1 == r.array_two().size());
+    check_spans(r);
+
+    // 容量为1时每次加入都覆盖唯一的元素
+    mystl::circular_buffer<int> one(1);
+    one.push_back(1);
+    one.push_back(2);
+    assert(1 == one.size() && 2 == one.front());
+
+    w.clear();
+    assert(w.empty() && 0 == w.array_one().size() && 0 == w.array_two().size());
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <assert.h>
+#include <stddef.h>
+#include "dary_heap.h"
+
+// Compare为greater时堆顶是最小元素，decrease_key即把值改小
+struct greater {
+    bool operator()(int a, int b) const { return a > b; }
+};
+
+static unsigned next_random(unsigned& seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) & 0x7fff;
+}
+
+// 在有向图上跑Dijkstra，结果与Bellman-Ford比较
+static void check_dijkstra()
+{
+    const int n = 200;
+    const int m = 2000;
+    int from[m], to[m], weight[m];
+    unsigned seed = 1;
+    for (int e = 0; e < m; ++e) {
+        from[e] = int(next_random(seed) % n);
+        to[e] = int(next_random(seed) % n);
+        weight[e] = int(next_random(seed) % 100) + 1;
+    }
+
+    const int inf = 1 << 30;
+    int expected[n];
+    for (int v = 0; v < n; ++v) {
+        expected[v] = inf;
+    }
+    expected[0] = 0;
+    for (int round = 0; round < n; ++round) {
+        for (int e = 0; e < m; ++e) {
+            if (expected[from[e]] != inf && expected[from[e]] + weight[e] < expected[to[e]]) {
+                expected[to[e]] = expected[from[e]] + weight[e];
+            }
+        }
+    }
+
+    mystl::indexed_dary_heap<int, 4, greater> heap;
+    mystl::slot_handle handles[n];
+    int dist[n];
+    bool done[n];
+    for (int v = 0; v < n; ++v) {
+        dist[v] = v == 0 ? 0 : inf;
+        done[v] = false;
+        handles[v] = heap.push(dist[v]);
+    }
+    while (!heap.empty()) {
+        mystl::slot_handle h = heap.top_handle();
+        int u = 0;
+        while (handles[u] != h) {
+            ++u;
+        }
+        heap.pop();
+        done[u] = true;
+        assert(!heap.contains(h));
+        if (dist[u] == inf) {
+            continue;
+        }
+        for (int e = 0; e < m; ++e) {
+            if (from[e] == u && !done[to[e]] && dist[u] + weight[e] < dist[to[e]]) {
+                dist[to[e]] = dist[u] + weight[e];
+                assert(heap.decrease_key(handles[to[e]], dist[to[e]]));
+                assert(dist[to[e]] == heap.get(handles[to[e]]));
+            }
+        }
+    }
+    for (int v = 0; v < n; ++v) {
+        assert(expected[v] == dist[v]);
+    }
+}
+
+static void check_stale_handles()
+{
+    mystl::indexed_dary_heap<int> heap;
+    mystl::slot_handle a = heap.push(5);
+    mystl::slot_handle b = heap.push(7);
+    assert(7 == heap.top() && heap.top_handle() == b);
+
+    // 失效的句柄不会改动堆，也不会指向复用同一格的新元素
+    assert(heap.erase(a));
+    assert(!heap.decrease_key(a, 100) && !heap.update(a, 100) && !heap.erase(a));
+    mystl::slot_handle c = heap.push(1);
+    assert(c.index == a.index && !heap.contains(a));
+    assert(!heap.update(a, 100));
+    assert(7 == heap.top() && 2 == heap.size());
+
+    assert(heap.update(c, 9) && heap.top_handle() == c);
+    assert(heap.update(c, 0) && heap.top_handle() == b);
+    assert(!heap.decrease_key(mystl::slot_handle(), 1));
+
+    // 副本与原堆互不影响
+    mystl::indexed_dary_heap<int> copy(heap);
+    assert(copy.update(b, -1) && 7 == heap.top() && 0 == copy.top());
+
+    heap.clear();
+    assert(heap.empty() && !heap.contains(b) && !heap.update(b, 1));
+}
+
+static void check_plain_heap()
+{
+    mystl::dary_heap<int, 3> heap;
+    unsigned seed = 7;
+    for (int i = 0; i < 1000; ++i) {
+        heap.push(int(next_random(seed)));
+    }
+    mystl::dary_heap<int, 3> copy(heap);
+    int last = heap.top();
+    while (!heap.empty()) {
+        assert(heap.top() <= last);
+        last = heap.top();
+        heap.pop();
+    }
+    assert(1000 == copy.size());
+}
+
+int main()
+{
+    check_dijkstra();
+    check_stale_handles();
+    check_plain_heap();
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <assert.h>
+#include <stddef.h>
+#include "flat_map.h"
+
+// 有序表中存放偶数0, 2, ..., 2(n-1)；查找每个奇数与偶数，结果须与线性扫描一致
+static size_t expected_lower_bound(size_t n, int k)
+{
+    size_t i = 0;
+    while (i < n && int(2 * i) < k) {
+        ++i;
+    }
+    return i;
+}
+
+static void check_set(size_t n)
+{
+    mystl::Vector<int> src;
+    for (size_t i = n; i > 0; --i) {
+        src.push_back(int(2 * (i - 1)));
+        src.push_back(int(2 * (i - 1))); // 重复的键应被去除
+    }
+    mystl::flat_set<int> s(src.begin(), src.end());
+    assert(n == s.size());
+
+    for (int pass = 0; pass < 2; ++pass) {
+        if (1 == pass) {
+            s.build_index();
+        }
+        for (int k = -1; k <= int(2 * n); ++k) {
+            size_t want = expected_lower_bound(n, k);
+            assert(want == size_t(s.lower_bound(k) - s.begin()));
+            bool present = k >= 0 && 0 == k % 2 && k < int(2 * n);
+            assert((present ? 1u : 0u) == s.count(k));
+        }
+    }
+
+    // 复制连同索引一起复制，修改副本不影响原表
+    mystl::flat_set<int> t(s);
+    assert(t.size() == s.size() && (0 == n || t.begin() != s.begin()));
+    assert((n > 0 ? 1u : 0u) == t.count(0));
+
+    // 修改会丢弃索引，之后的查找仍然正确
+    t.insert(-4);
+    assert(0 == t.lower_bound(-5) - t.begin());
+    assert(1 == t.count(-4) && 0 == s.count(-4));
+    s = t;
+    assert(1 == s.count(-4) && n + 1 == s.size());
+}
+
+static void check_map(size_t n)
+{
+    mystl::Vector<std::pair<int, int> > src;
+    for (size_t i = 0; i < n; ++i) {
+        int k = int(2 * ((i * 7) % n)); // 打乱次序
+        src.push_back(std::pair<int, int>(k, k * 10));
+    }
+    mystl::flat_map<int, int> m(src.begin(), src.end());
+    assert(n == m.size());
+    m.build_index();
+    for (int k = -1; k <= int(2 * n); ++k) {
+        mystl::flat_map<int, int>::iterator it = m.find(k);
+        if (k >= 0 && 0 == k % 2 && k < int(2 * n)) {
+            assert(it != m.end() && k == it.key() && k * 10 == it.value());
+        } else {
+            assert(it == m.end());
+        }
+    }
+
+    mystl::flat_map<int, int> copy;
+    copy = m;
+    copy[-2] = 7;
+    assert(n + 1 == copy.size() && n == m.size() && 0 == m.count(-2));
+    assert(0 == n || 0 == copy.find(0).value());
+}
+
+int main()
+{
+    // 覆盖完全二叉树各种填充程度，以及prefetch触及末尾附近的大小
+    for (size_t n = 0; n < 300; ++n) {
+        check_set(n);
+    }
+    check_set(4096);
+    check_map(1);
+    check_map(97);  // 与7互质，保证打乱后没有重复的键
+    check_map(1003);
+    return 0;
+}
@@ -0,0 +1,72 @@
+// 每个头文件都能单独编译，且主要的类模板能完整实例化
+#include <assert.h>
+#include "vector.h"
+#include "object_pool.h"
+#include "soa_vector.h"
+#include "concurrent_vector.h"
+#include "ring_queue.h"
+#include "thread_pool.h"
+#include "parallel_algo.h"
+#include "radix_sort.h"
+#include "range_view.h"
+#include "basic_string.h"
+#include "bit_vector.h"
+#include "flat_map.h"
+#include "slot_map.h"
+#include "memory_resource.h"
+#include "pmr_vector.h"
+#include "dary_heap.h"
+#include "vector_io.h"
+#include "deque.h"
+#include "circular_buffer.h"
+
+namespace mystl {
+
+template class Vector<int>;
+template class object_pool<int>;
+template class object_pool<int, true>;
+template class basic_soa_vector<mystl::alloc, int, double>;
+template class concurrent_vector<int>;
+template class mpmc_queue<int>;
+template class spsc_queue<int>;
+template class basic_string<char>;
+template class basic_bit_vector<>;
+template class flat_set<int>;
+template class flat_map<int, int>;
+template class slot_map<int>;
+template class pmr::polymorphic_allocator<int>;
+template class pmr::Vector<int>;
+template class dary_heap<int>;
+template class indexed_dary_heap<int>;
+template class Deque<int>;
+template class circular_buffer<int>;
+
+}
+
+static bool is_even(int x) { return 0 == x % 2; }
+static int twice(int x) { return 2 * x; }
+
+int main()
+{
+    mystl::Vector<int> v;
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(99 - i);
+    }
+
+    mystl::radix_sort(v.begin(), v.end());
+    assert(0 == v[0] && 99 == v[99]);
+
+    mystl::parallel_sort(v.begin(), v.end());
+    assert(4950 == mystl::parallel_reduce(v.begin(), v.end(), 0));
+
+    int sum = 0;
+    for (int x : v | mystl::filter(is_even) | mystl::transform(twice) | mystl::take(3)) {
+        sum += x;
+    }
+    assert(0 + 4 + 8 == sum);
+
+    mystl::make_dary_heap<4>(v.begin(), v.end());
+    assert(99 == v[0]);
+
+    return 0;
+}
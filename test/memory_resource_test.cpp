@@ -0,0 +1,38 @@
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+#include "memory_resource.h"
+
+using mystl::pmr::memory_resource;
+
+// 各种对齐要求下配置的空间都按要求对齐、可写，并能以同样的参数释放
+static void check_alignments(memory_resource *r)
+{
+    const size_t alignments[] = { 1, 8, 16, 32, 64, 256, 4096 };
+    const size_t sizes[] = { 0, 1, 24, 100, 5000 };
+    for (size_t i = 0; i < sizeof(alignments) / sizeof(alignments[0]); ++i) {
+        for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); ++j) {
+            size_t a = alignments[i];
+            size_t n = sizes[j];
+            void *p = r->allocate(n, a);
+            assert(0 != p && 0 == (size_t)p % a);
+            memset(p, 0x5a, n);
+            r->deallocate(p, n, a);
+        }
+    }
+}
+
+int main()
+{
+    check_alignments(mystl::pmr::node_alloc_resource());
+    check_alignments(mystl::pmr::malloc_alloc_resource());
+
+    // arena的上游资源也会收到大对齐的请求
+    mystl::pmr::monotonic_buffer_resource arena(64, mystl::pmr::malloc_alloc_resource());
+    check_alignments(&arena);
+    arena.release();
+
+    assert(*mystl::pmr::node_alloc_resource() == *mystl::pmr::node_alloc_resource());
+    assert(!(arena == *mystl::pmr::node_alloc_resource()));
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "object_pool.h"
+
+struct counted {
+    static std::atomic<int> alive;
+    int value;
+    explicit counted(int v) : value(v) { ++alive; }
+    ~counted() { --alive; }
+};
+
+std::atomic<int> counted::alive(0);
+
+struct alignas(64) wide {
+    char bytes[10];
+};
+
+// clear()须收回cache中的空闲区块，且只析构真正存活的对象
+static void test_clear_with_cache()
+{
+    mystl::object_pool<counted> pool;
+    {
+        mystl::object_pool<counted>::cache c(pool, 8);
+        counted *p[20];
+        for (int i = 0; i < 20; ++i) {
+            p[i] = c.create(i);
+        }
+        for (int i = 0; i < 5; ++i) {
+            c.destroy(p[i]); // 留在cache中，未归还
+        }
+        assert(15 == counted::alive);
+        pool.clear();
+        assert(0 == counted::alive && 0 == pool.size());
+
+        // clear()之后cache仍可使用
+        counted *q = c.create(7);
+        assert(7 == q->value && 1 == counted::alive);
+        c.destroy(q);
+    }
+    assert(0 == pool.size() && 0 == counted::alive);
+}
+
+static void test_over_aligned()
+{
+    mystl::object_pool<wide> pool;
+    std::vector<wide*> v;
+    for (int i = 0; i < 200; ++i) {
+        wide *p = pool.create();
+        assert(0 == (uintptr_t)p % 64);
+        v.push_back(p);
+    }
+    for (size_t i = 0; i < v.size(); ++i) {
+        pool.destroy(v[i]);
+    }
+    assert(0 == pool.size() && pool.capacity() >= 200);
+}
+
+static void test_threads()
+{
+    typedef mystl::object_pool<counted, true> pool_type;
+    pool_type pool;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.push_back(std::thread([&pool, t] {
+            pool_type::cache c(pool, 16);
+            std::vector<counted*> mine;
+            for (int i = 0; i < 10000; ++i) {
+                mine.push_back(c.create(i));
+                if (i % 3 == t % 3) {
+                    c.destroy(mine.back());
+                    mine.pop_back();
+                }
+                (void)pool.size();
+                (void)pool.capacity();
+            }
+            for (size_t i = 0; i < mine.size(); ++i) {
+                c.destroy(mine[i]);
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
+    }
+    assert(0 == pool.size() && 0 == counted::alive);
+}
+
+int main()
+{
+    test_clear_with_cache();
+    test_over_aligned();
+    test_threads();
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <assert.h>
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+#include "parallel_algo.h"
+
+// 递归fork-join：每一层的wait()都可能在条件变量上休眠，由另一线程上最后完成的任务唤醒
+static long fib(mystl::work_stealing_pool& pool, int n)
+{
+    if (n < 12) {
+        return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+    }
+    long a = 0;
+    long b = 0;
+    mystl::parallel_invoke(pool, [&] { a = fib(pool, n - 1); }, [&] { b = fib(pool, n - 2); });
+    return a + b;
+}
+
+int main()
+{
+    const size_t n = 200000;
+
+    // 标准库迭代器也走随机访问的并行版本
+    std::vector<long> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = long((i * 7919) % n);
+    }
+    mystl::parallel_sort(v.begin(), v.end());
+    for (size_t i = 0; i < n; ++i) {
+        assert(long(i) == v[i]);
+    }
+    assert(long(n) * long(n - 1) / 2 == mystl::parallel_reduce(v.begin(), v.end(), 0L));
+
+    std::atomic<long> sum(0);
+    mystl::parallel_for_each(v.begin(), v.end(), [&sum](long x) { sum.fetch_add(x, std::memory_order_relaxed); });
+    assert(long(n) * long(n - 1) / 2 == sum.load());
+
+    std::vector<long> out(n);
+    mystl::parallel_inclusive_scan(v.cbegin(), v.cend(), out.begin());
+    assert(long(n) * long(n - 1) / 2 == out[n - 1] && 1 == out[1]);
+
+    // 工作线程多于任务、以及没有工作线程两种情况
+    for (size_t threads = 0; threads < 5; threads += 4) {
+        mystl::work_stealing_pool pool(threads);
+        for (int round = 0; round < 20; ++round) {
+            assert(6765 == fib(pool, 20));
+        }
+    }
+    return 0;
+}
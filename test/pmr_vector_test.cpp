@@ -0,0 +1,83 @@
+#include <assert.h>
+#include <stddef.h>
+#include "pmr_vector.h"
+
+using mystl::pmr::memory_resource;
+
+// 记录配置与释放的字节数，检查pmr::Vector经由所给的资源配置空间
+class counting_resource : public memory_resource {
+public:
+    size_t outstanding;
+
+    counting_resource() : outstanding(0) {}
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment)
+    {
+        outstanding += bytes;
+        return mystl::pmr::malloc_alloc_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment)
+    {
+        outstanding -= bytes;
+        mystl::pmr::malloc_alloc_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const memory_resource& x) const
+    {
+        return this == &x;
+    }
+};
+
+struct alignas(64) wide {
+    int v;
+};
+
+int main()
+{
+    counting_resource r1;
+    counting_resource r2;
+    {
+        mystl::pmr::Vector<int> a(&r1);
+        for (int i = 0; i < 100; ++i) {
+            a.push_back(i);
+        }
+        assert(&r1 == a.resource() && r1.outstanding >= 100 * sizeof(int));
+        a.erase(a.begin(), a.begin() + 10);
+        assert(90 == a.size() && 10 == a[0]);
+
+        // 复制不传播资源，可另行指定
+        mystl::pmr::Vector<int> b(a, &r2);
+        assert(&r2 == b.resource() && 90 == b.size() && 99 == b.back());
+        mystl::pmr::Vector<int> c(a);
+        assert(mystl::pmr::get_default_resource() == c.resource());
+
+        // 资源不同时交换内容，各自的资源不变
+        b.resize(5);
+        a.swap(b);
+        assert(5 == a.size() && 90 == b.size() && &r1 == a.resource() && &r2 == b.resource());
+
+        // 移动沿用原资源
+        mystl::pmr::Vector<int> d(static_cast<mystl::pmr::Vector<int>&&>(b));
+        assert(&r2 == d.resource() && 90 == d.size() && b.empty());
+
+        mystl::pmr::Vector<int> e(3, 7, &r1);
+        assert(3 == e.size() && 7 == e[2]);
+        e = d;
+        assert(90 == e.size() && &r1 == e.resource());
+    }
+    assert(0 == r1.outstanding && 0 == r2.outstanding);
+
+    // 对齐要求超过max_align_t的元素
+    mystl::pmr::monotonic_buffer_resource arena(256);
+    mystl::pmr::Vector<wide> w(&arena);
+    for (int i = 0; i < 50; ++i) {
+        wide x = { i };
+        w.push_back(x);
+        assert(0 == (size_t)&w.back() % 64);
+    }
+    mystl::pmr::Vector<wide> heap_w(w);
+    assert(0 == (size_t)heap_w.begin() % 64 && 49 == heap_w.back().v);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <assert.h>
+#include "range_view.h"
+
+static bool is_odd(int x) { return 1 == x % 2; }
+static int square(int x) { return x * x; }
+
+// 以const引用传入的容器也能接上视图，且不会被复制
+static int sum_odd_squares(const mystl::Vector<int>& cv)
+{
+    int sum = 0;
+    for (int x : cv | mystl::filter(is_odd) | mystl::transform(square)) {
+        sum += x;
+    }
+    return sum;
+}
+
+int main()
+{
+    mystl::Vector<int> v;
+    for (int i = 0; i < 10; ++i) {
+        v.push_back(i);
+    }
+    const mystl::Vector<int>& cv = v;
+
+    assert(1 + 9 + 25 + 49 + 81 == sum_odd_squares(v));
+
+    mystl::Vector<int> out;
+    mystl::to_vector(cv | mystl::take(3), out);
+    assert(3 == out.size() && 0 == out[0] && 2 == out[2]);
+
+    out.clear();
+    mystl::to_vector(cv | mystl::chunk(4) | mystl::transform(
+        [](const mystl::iterator_range<const int*>& c) { return int(c.end() - c.begin()); }), out);
+    assert(3 == out.size() && 4 == out[0] && 2 == out[2]);
+
+    int n = 0;
+    for (auto pr : mystl::zip(cv, cv)) {
+        assert(pr.first == pr.second);
+        ++n;
+    }
+    assert(10 == n);
+
+    // 非const容器经视图仍可写
+    for (auto pr : mystl::zip(v, cv)) {
+        pr.first = 0;
+    }
+    assert(0 == v[9]);
+
+    // transform_iterator是完整的随机访问迭代器
+    mystl::Vector<int> w;
+    w.push_back(3);
+    w.push_back(1);
+    w.push_back(2);
+    auto t = w | mystl::transform(square);
+    auto b = t.begin(), e = t.end();
+    assert(b < e && e > b && b <= b && e >= b && !(e <= b) && !(b >= e));
+    assert(3 == e - b && 1 == b[1] && 4 == *(b + 2));
+    return 0;
+}
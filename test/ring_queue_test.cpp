@@ -0,0 +1,129 @@
+#include <assert.h>
+#include <stddef.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ring_queue.h"
+
+// 复制可能抛出异常、移动不会的型别
+struct throwing_copy {
+    static bool fail;
+    int v;
+
+    explicit throwing_copy(int x = 0) : v(x) {}
+    throwing_copy(const throwing_copy& x) : v(x.v)
+    {
+        if (fail) {
+            throw 1;
+        }
+    }
+    throwing_copy(throwing_copy&& x) noexcept : v(x.v) {}
+    throwing_copy& operator=(const throwing_copy&) = default;
+    throwing_copy& operator=(throwing_copy&&) noexcept = default;
+};
+
+bool throwing_copy::fail = false;
+
+// 复制在占用槽位之前失败，队列仍然可用
+static void check_throwing_push()
+{
+    mystl::mpmc_queue<throwing_copy> q(2);
+    throwing_copy a(1);
+    throwing_copy::fail = true;
+    bool thrown = false;
+    try {
+        q.try_push(a);
+    } catch (int) {
+        thrown = true;
+    }
+    assert(thrown);
+    throwing_copy::fail = false;
+    assert(q.try_push(a) && q.try_push(throwing_copy(2)) && !q.try_push(a));
+    throwing_copy out;
+    assert(q.try_pop(out) && 1 == out.v);
+    assert(q.try_pop(out) && 2 == out.v);
+    assert(!q.try_pop(out));
+}
+
+// 批量入队/出队不超过容量，也不越过空队列
+static void check_batch_bounds()
+{
+    mystl::mpmc_queue<int> q(8);
+    int in[20];
+    for (int i = 0; i < 20; ++i) {
+        in[i] = i;
+    }
+    assert(8 == q.try_push_n(in, 20));
+    assert(0 == q.try_push_n(in, 1));
+    int out[20];
+    assert(5 == q.try_pop_n(out, 5));
+    assert(0 == out[0] && 4 == out[4]);
+    assert(5 == q.try_push_n(in + 8, 12));
+    assert(8 == q.try_pop_n(out, 20));
+    for (int i = 0; i < 8; ++i) {
+        assert(i + 5 == out[i]);
+    }
+    assert(0 == q.try_pop_n(out, 20));
+}
+
+// 多生产者多消费者：每个值恰好出队一次
+static void check_concurrent()
+{
+    const int producers = 4;
+    const int consumers = 4;
+    const int per_producer = 20000;
+    const int batch = 7;
+    mystl::mpmc_queue<int> q(64);
+    std::atomic<long> sum(0);
+    std::atomic<int> popped(0);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; ++p) {
+        threads.push_back(std::thread([&q, p] {
+            int buf[batch];
+            int next = 0;
+            while (next < per_producer) {
+                int k = 0;
+                for (; k < batch && next + k < per_producer; ++k) {
+                    buf[k] = p * per_producer + next + k;
+                }
+                size_t pushed = q.try_push_n(buf, k);
+                if (0 == pushed) {
+                    std::this_thread::yield(); // 队列已满，让出CPU给消费者
+                }
+                next += int(pushed);
+            }
+        }));
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.push_back(std::thread([&] {
+            int buf[batch];
+            while (popped.load() < producers * per_producer) {
+                size_t k = q.try_pop_n(buf, batch);
+                if (0 == k) {
+                    std::this_thread::yield();
+                }
+                long s = 0;
+                for (size_t i = 0; i < k; ++i) {
+                    s += buf[i];
+                }
+                sum.fetch_add(s);
+                popped.fetch_add(int(k));
+            }
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    long total = long(producers) * per_producer;
+    assert(total == popped.load());
+    assert(total * (total - 1) / 2 == sum.load());
+}
+
+int main()
+{
+    check_throwing_push();
+    check_batch_bounds();
+    check_concurrent();
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include <assert.h>
+#include "slot_map.h"
+
+int main()
+{
+    mystl::slot_map<int> m;
+    mystl::slot_handle a = m.insert(10);
+    mystl::slot_handle b = m.insert(20);
+    mystl::slot_handle c = m.insert(30);
+    assert(3 == m.size() && 20 == *m.get(b));
+
+    // 删除a后最后一个元素被搬到空位上，其余句柄仍指向原来的元素
+    assert(m.erase(a));
+    assert(!m.contains(a) && 0 == m.get(a));
+    assert(!m.erase(a));
+    assert(20 == *m.get(b) && 30 == *m.get(c) && 2 == m.size());
+
+    // 新元素复用a的格，但世代号不同，旧句柄不会指向它
+    mystl::slot_handle d = m.insert(40);
+    assert(a.index == d.index && a.generation != d.generation);
+    assert(!m.contains(a) && 0 == m.get(a));
+    assert(40 == *m.get(d));
+
+    // 经由64位整数存取的句柄与原句柄相同
+    assert(d == mystl::slot_handle::from_value(d.value()));
+    assert(!m.contains(mystl::slot_handle::from_value(a.value())));
+
+    // 越界与默认构造的句柄都无效
+    assert(!m.contains(mystl::slot_handle()));
+    assert(!m.contains(mystl::slot_handle(100, 1)));
+
+    // 遍历时取得的句柄指向对应的元素
+    for (size_t i = 0; i < m.size(); ++i) {
+        assert(&m.begin()[i] == m.get(m.handle_at(i)));
+    }
+
+    // 副本有独立的空间和相同的句柄
+    mystl::slot_map<int> copy(m);
+    *copy.get(b) = 21;
+    assert(20 == *m.get(b) && 21 == *copy.get(b));
+
+    // clear之后所有句柄失效，再插入时同样不会被旧句柄误认
+    m.clear();
+    assert(m.empty() && !m.contains(b) && !m.contains(c) && !m.contains(d));
+    mystl::slot_handle e = m.insert(50);
+    assert(!m.contains(b) && !m.contains(c) && !m.contains(d) && 50 == *m.get(e));
+    assert(copy.contains(b) && copy.contains(d));
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <assert.h>
+#include "soa_vector.h"
+
+// 复制第throw_at次时抛出异常，并统计存活对象个数
+struct fragile {
+    static int alive;
+    static int copies;
+    static int throw_at;
+
+    int v;
+
+    fragile() : v(0) { ++alive; }
+    explicit fragile(int x) : v(x) { ++alive; }
+    fragile(const fragile& x) : v(x.v)
+    {
+        if (++copies == throw_at) {
+            throw 1;
+        }
+        ++alive;
+    }
+    ~fragile() { --alive; }
+};
+
+int fragile::alive = 0;
+int fragile::copies = 0;
+int fragile::throw_at = -1;
+
+int main()
+{
+    {
+        mystl::soa_vector<int, fragile> v;
+        for (int i = 0; i < 8; ++i) {
+            v.push_back(i, fragile(i));
+        }
+        assert(8 == fragile::alive && 8 == v.capacity());
+
+        // 扩容时第二列的搬迁中途失败：原有内容不变，新空间中已构造的元素被析构
+        fragile::copies = 0;
+        fragile::throw_at = 4;
+        bool thrown = false;
+        try {
+            v.push_back(8, fragile(8));
+        } catch (int) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(8 == v.size() && 8 == v.capacity());
+        assert(8 == fragile::alive);
+        for (int i = 0; i < 8; ++i) {
+            assert(i == v.data<0>()[i] && i == v.data<1>()[i].v);
+        }
+
+        fragile::throw_at = -1;
+        v.push_back(8, fragile(8));
+        assert(9 == v.size() && 9 == fragile::alive);
+        assert(8 == v.data<1>()[8].v && 3 == v.data<1>()[3].v);
+
+        v.resize(20);
+        assert(20 == fragile::alive && 0 == v.data<1>()[19].v);
+    }
+    assert(0 == fragile::alive);
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <thread>
+#include "vector_io.h"
+
+static int temp_file()
+{
+    char name[] = "/tmp/mystl_vector_io_XXXXXX";
+    int fd = mkstemp(name);
+    assert(fd >= 0);
+    unlink(name);
+    return fd;
+}
+
+static void fill(mystl::Vector<int>& v, int n, int seed)
+{
+    v.clear();
+    for (int i = 0; i < n; ++i) {
+        v.push_back(i * 7 + seed);
+    }
+}
+
+static bool same(const mystl::Vector<int>& a, const mystl::Vector<int>& b)
+{
+    return a.size() == b.size() && 0 == memcmp(a.begin(), b.begin(), a.size() * sizeof(int));
+}
+
+// 文件：顺序写读、按偏移写读
+static void test_file_round_trip()
+{
+    int fd = temp_file();
+    mystl::Vector<int> a, b, empty, r;
+    fill(a, 1000, 1);
+    fill(b, 3, 2);
+    assert(0 == mystl::serialize(fd, a));
+    assert(0 == mystl::serialize(fd, empty));
+    assert(0 == mystl::serialize(fd, b));
+    assert(0 == lseek(fd, 0, SEEK_SET));
+    fill(r, 5000, 9); // 原有内容被取代
+    assert(0 == mystl::deserialize(fd, r) && same(r, a));
+    assert(0 == mystl::deserialize(fd, r) && r.empty());
+    assert(0 == mystl::deserialize(fd, r) && same(r, b));
+
+    off_t off = 4096;
+    assert(0 == mystl::serialize_at(fd, off, b));
+    assert(0 == mystl::serialize_at(fd, off + (off_t)mystl::serialized_size(b), a));
+    assert(0 == mystl::deserialize_at(fd, off + (off_t)mystl::serialized_size(b), r) && same(r, a));
+    assert(0 == mystl::deserialize_at(fd, off, r) && same(r, b));
+    close(fd);
+}
+
+// 头部错误、元素个数超过文件长度、文件被截断
+static void test_file_errors()
+{
+    int fd = temp_file();
+    mystl::Vector<int> a, r;
+    fill(a, 100, 3);
+    assert(0 == mystl::serialize_at(fd, 0, a));
+
+    mystl::Vector<short> wrong_size;
+    errno = 0;
+    assert(-1 == mystl::deserialize_at(fd, 0, wrong_size) && EINVAL == errno);
+
+    mystl::__vector_io_header h;
+    assert(sizeof(h) == (size_t)pread(fd, &h, sizeof(h), 0));
+    h.count = uint64_t(1) << 40; // 远超文件长度
+    assert(sizeof(h) == (size_t)pwrite(fd, &h, sizeof(h), 0));
+    errno = 0;
+    assert(-1 == mystl::deserialize_at(fd, 0, r) && EINVAL == errno && r.empty());
+
+    h.count = SIZE_MAX / 2; // count * elem_size溢出
+    assert(sizeof(h) == (size_t)pwrite(fd, &h, sizeof(h), 0));
+    errno = 0;
+    assert(-1 == mystl::deserialize_at(fd, 0, r) && EINVAL == errno);
+
+    h.count = 100;
+    memcpy(h.magic, "XXXX", 4);
+    assert(sizeof(h) == (size_t)pwrite(fd, &h, sizeof(h), 0));
+    errno = 0;
+    assert(-1 == mystl::deserialize_at(fd, 0, r) && EINVAL == errno);
+
+    memcpy(h.magic, "MSTV", 4);
+    assert(sizeof(h) == (size_t)pwrite(fd, &h, sizeof(h), 0));
+    assert(0 == ftruncate(fd, sizeof(h) + 10 * sizeof(int)));
+    errno = 0;
+    assert(-1 == mystl::deserialize_at(fd, 0, r) && EINVAL == errno);
+    close(fd);
+}
+
+// socket：数据跨越多个读取块；对端声称巨大的元素个数后断开
+static void test_socket()
+{
+    int sv[2];
+    assert(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    mystl::Vector<int> a, r;
+    fill(a, 100000, 4);
+    std::thread writer([&] { assert(0 == mystl::serialize(sv[0], a)); });
+    assert(0 == mystl::deserialize(sv[1], r) && same(r, a));
+    writer.join();
+
+    mystl::__vector_io_header h;
+    mystl::__vector_io_make_header(h, sizeof(int), size_t(1) << 40);
+    assert(sizeof(h) == (size_t)write(sv[0], &h, sizeof(h)));
+    assert(sizeof(int) == (size_t)write(sv[0], &h, sizeof(int)));
+    close(sv[0]);
+    errno = 0;
+    assert(-1 == mystl::deserialize(sv[1], r) && EIO == errno && r.empty());
+    close(sv[1]);
+}
+
+#ifdef __linux__
+static void test_send_serialized()
+{
+    int fd = temp_file();
+    mystl::Vector<int> a, r;
+    fill(a, 5000, 5);
+    assert(0 == mystl::serialize_at(fd, 100, a));
+    int sv[2];
+    assert(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    std::thread sender([&] { assert(0 == mystl::send_serialized(sv[0], fd, 100)); });
+    assert(0 == mystl::deserialize(sv[1], r) && same(r, a));
+    sender.join();
+    close(sv[0]);
+    close(sv[1]);
+    close(fd);
+}
+#endif
+
+int main()
+{
+    test_file_round_trip();
+    test_file_errors();
+    test_socket();
+#ifdef __linux__
+    test_send_serialized();
+#endif
+    return 0;
+}
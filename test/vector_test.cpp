@@ -0,0 +1,78 @@
+#include <assert.h>
+#include "vector.h"
+
+// 统计存活对象个数，检查复制与赋值不会重复析构或遗漏析构
+struct counted {
+    static int alive;
+    int v;
+
+    explicit counted(int x = 0) : v(x) { ++alive; }
+    counted(const counted& x) : v(x.v) { ++alive; }
+    counted& operator=(const counted& x) { v = x.v; return *this; }
+    ~counted() { --alive; }
+};
+
+int counted::alive = 0;
+
+static void fill(mystl::Vector<counted>& v, int n, int base)
+{
+    v.clear();
+    for (int i = 0; i < n; ++i) {
+        v.push_back(counted(base + i));
+    }
+}
+
+static bool equal(const mystl::Vector<counted>& a, const mystl::Vector<counted>& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].v != b[i].v) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    {
+        mystl::Vector<counted> a;
+        fill(a, 10, 0);
+
+        // 复制构造得到独立的空间
+        mystl::Vector<counted> b(a);
+        assert(equal(a, b) && a.begin() != b.begin());
+        b[0].v = 100;
+        assert(0 == a[0].v);
+        assert(20 == counted::alive);
+
+        // 赋值的三种情形：容量不足、缩短、在容量以内增长
+        mystl::Vector<counted> c;
+        c = a;
+        assert(equal(a, c));
+
+        mystl::Vector<counted> d;
+        fill(d, 15, 50);
+        d = a;
+        assert(equal(a, d) && 15 <= d.capacity());
+
+        mystl::Vector<counted> e;
+        e.reserve(16);
+        fill(e, 3, 70);
+        counted *old = e.begin();
+        e = a;
+        assert(equal(a, e) && old == e.begin());
+
+        e = e;
+        assert(equal(a, e));
+        assert(50 == counted::alive);
+
+        mystl::Vector<counted> empty;
+        e = empty;
+        assert(e.empty() && 40 == counted::alive);
+    }
+    assert(0 == counted::alive);
+    return 0;
+}
@@ -0,0 +1,313 @@
+#ifndef MYSTL_THREAD_POOL_H_
+#define MYSTL_THREAD_POOL_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 工作窃取（work-stealing）线程池
+ * 每个工作线程拥有一个任务队列：自己从队尾压入、从队尾取出（LIFO，最近产生的任务数据还在cache里），
+ * 空闲时从其他线程队列的队头窃取（FIFO，偷走的往往是较大的子问题）。池外线程提交的任务放入单独的注入队列。
+ * task_group::wait()在等待期间也会执行队列中的任务，因此递归的fork-join不会让线程空等，
+ * 即使没有工作线程（单核机器）也能由调用线程独自完成全部任务。
+ * 队列中已无任务、本组任务仍在其他线程上执行时，wait()在本组的条件变量上休眠，由最后完成的任务唤醒。
+ */
+
+namespace mystl {
+
+class work_stealing_pool;
+
+class task_group;
+
+class __task {
+public:
+    task_group *group;
+
+    __task() : group(0) {}
+    virtual ~__task() {}
+    virtual void execute() = 0;
+};
+
+template <class Function>
+class __function_task : public __task {
+public:
+    explicit __function_task(const Function& f) : fn(f) {}
+    void execute() { fn(); }
+
+private:
+    Function fn;
+};
+
+class work_stealing_pool {
+public:
+    // nthreads为工作线程数，不含调用线程；默认为硬件线程数减一
+    explicit work_stealing_pool(size_t nthreads = default_threads())
+        : queues(nthreads + 1), queued(0), sleepers(0), stop(false)
+    {
+        for (size_t i = 0; i < nthreads; ++i) {
+            threads.push_back(std::thread(&work_stealing_pool::worker_loop, this, i));
+        }
+    }
+
+    ~work_stealing_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stop = true;
+        }
+        sleep_cv.notify_all();
+        for (size_t i = 0; i < threads.size(); ++i) {
+            threads[i].join();
+        }
+    }
+
+    // 参与计算的线程总数（工作线程加上调用线程）
+    size_t concurrency() const
+    {
+        return threads.size() + 1;
+    }
+
+    // 进程内共享的默认线程池
+    static work_stealing_pool& instance()
+    {
+        static work_stealing_pool pool;
+        return pool;
+    }
+
+    static size_t default_threads()
+    {
+        size_t n = std::thread::hardware_concurrency();
+        return n > 1 ? n - 1 : 0;
+    }
+
+    // 工作线程压入自己的队列，其他线程压入注入队列
+    void push(__task *t)
+    {
+        worker_queue& q = queues[self_index()];
+        {
+            std::lock_guard<std::mutex> lock(q.m);
+            q.tasks.push_back(t);
+        }
+        // 与worker_loop中的sleepers/queued成对使用seq_cst：要么此处看到有线程在睡，
+        // 要么该线程在入睡前的判断中看到queued > 0，不会错过任务
+        queued.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_seq_cst) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex); // 等睡眠线程进入wait后再通知
+            }
+            sleep_cv.notify_one();
+        }
+    }
+
+    // 先取自己队尾的任务，再依次窃取其他队列队头的任务
+    __task *pop()
+    {
+        if (0 == queued.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        size_t n = queues.size();
+        size_t self = self_index();
+        __task *t = take_back(queues[self]);
+        if (t) {
+            return t;
+        }
+        for (size_t k = 1; k < n; ++k) {
+            t = take_front(queues[(self + k) % n]);
+            if (t) {
+                return t;
+            }
+        }
+        return 0;
+    }
+
+    void run(__task *t);
+
+private:
+    // 每个队列独占cache line，避免相邻队列的锁互相干扰
+    struct alignas(64) worker_queue {
+        std::mutex m;
+        std::deque<__task*> tasks;
+    };
+
+    std::vector<worker_queue> queues; // 最后一个是注入队列
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued;        // 所有队列中的任务总数
+    std::atomic<size_t> sleepers;      // 正在（或即将）等待sleep_cv的工作线程数
+    bool stop;
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+
+    static work_stealing_pool *&current_pool()
+    {
+        static thread_local work_stealing_pool *pool = 0;
+        return pool;
+    }
+
+    static size_t &current_index()
+    {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    size_t self_index() const
+    {
+        return current_pool() == this ? current_index() : queues.size() - 1;
+    }
+
+    __task *take_back(worker_queue& q)
+    {
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.tasks.empty()) {
+            return 0;
+        }
+        __task *t = q.tasks.back();
+        q.tasks.pop_back();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return t;
+    }
+
+    __task *take_front(worker_queue& q)
+    {
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.tasks.empty()) {
+            return 0;
+        }
+        __task *t = q.tasks.front();
+        q.tasks.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return t;
+    }
+
+    void worker_loop(size_t index)
+    {
+        current_pool() = this;
+        current_index() = index;
+        for (;;) {
+            __task *t = pop();
+            if (t) {
+                run(t);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            if (stop) {
+                return;
+            }
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            sleep_cv.wait(lock, [this] {
+                return stop || queued.load(std::memory_order_seq_cst) > 0;
+            });
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    work_stealing_pool(const work_stealing_pool&);
+    work_stealing_pool& operator=(const work_stealing_pool&);
+};
+
+/**
+ * @brief 一组fork-join任务
+ * run()把任务交给线程池，wait()等待本组任务全部完成，期间帮忙执行池中的任务。
+ * 省略异常处理：任务不应抛出异常。
+ */
+class task_group {
+public:
+    explicit task_group(work_stealing_pool& p = work_stealing_pool::instance())
+        : pool(p), pending(0) {}
+
+    ~task_group()
+    {
+        wait();
+    }
+
+    template <class Function>
+    void run(const Function& f)
+    {
+        __task *t = new __function_task<Function>(f);
+        t->group = this;
+        pending.fetch_add(1, std::memory_order_relaxed);
+        pool.push(t);
+    }
+
+    void wait()
+    {
+        while (pending.load(std::memory_order_acquire) > 0) {
+            __task *t = pool.pop();
+            if (t) {
+                pool.run(t);
+                continue;
+            }
+            // 本组剩下的任务都已被其他线程取走，睡到最后一个完成为止
+            std::unique_lock<std::mutex> lock(wait_mutex);
+            wait_cv.wait(lock, [this] {
+                return 0 == pending.load(std::memory_order_acquire);
+            });
+        }
+        // 最后一个任务在锁内把pending减到0，取一次锁确保该线程已不再访问本对象，之后才可析构
+        std::lock_guard<std::mutex> lock(wait_mutex);
+    }
+
+    work_stealing_pool& get_pool() const
+    {
+        return pool;
+    }
+
+private:
+    friend class work_stealing_pool;
+
+    work_stealing_pool& pool;
+    std::atomic<size_t> pending;
+    std::mutex wait_mutex;
+    std::condition_variable wait_cv;
+
+    // 非最后一个任务只做一次CAS；最后一个在锁内减到0并唤醒wait()，与push()先取锁再通知同一思路，不会错过唤醒
+    void finish_one()
+    {
+        size_t n = pending.load(std::memory_order_relaxed);
+        while (n > 1) {
+            if (pending.compare_exchange_weak(n, n - 1, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> lock(wait_mutex);
+        if (1 == pending.fetch_sub(1, std::memory_order_release)) {
+            wait_cv.notify_all();
+        }
+    }
+
+    task_group(const task_group&);
+    task_group& operator=(const task_group&);
+};
+
+inline void work_stealing_pool::run(__task *t)
+{
+    task_group *g = t->group;
+    t->execute();
+    delete t;
+    g->finish_one();
+}
+
+// 并行执行f和g，返回时两者均已完成
+template <class F, class G>
+inline void parallel_invoke(work_stealing_pool& pool, const F& f, const G& g)
+{
+    task_group group(pool);
+    group.run(g);
+    f();
+    group.wait();
+}
+
+template <class F, class G>
+inline void parallel_invoke(const F& f, const G& g)
+{
+    parallel_invoke(work_stealing_pool::instance(), f, g);
+}
+
+}
+
+#endif
@@ -107,6 +107,24 @@ struct __type_traits<unsigned long> {
     typedef __true_type    is_POD_type;
 };
 
+template <> // 全特化
+struct __type_traits<long long> {
+    typedef __true_type    has_trivial_default_constructor;
+    typedef __true_type    has_trivial_copy_constructor;
+    typedef __true_type    has_trivial_assignment_operator;
+    typedef __true_type    has_trivial_destructor;
+    typedef __true_type    is_POD_type;
+};
+
+template <> // 全特化
+struct __type_traits<unsigned long long> {
+    typedef __true_type    has_trivial_default_constructor;
+    typedef __true_type    has_trivial_copy_constructor;
+    typedef __true_type    has_trivial_assignment_operator;
+    typedef __true_type    has_trivial_destructor;
+    typedef __true_type    is_POD_type;
+};
+
 template <> // 全特化
 struct __type_traits<float> {
     typedef __true_type    has_trivial_default_constructor;
@@ -0,0 +1,42 @@
+#ifndef MYSTL_UTIL_H_
+#define MYSTL_UTIL_H_
+
+#include <stddef.h>
+
+/**
+ * @brief 各容器共用的小工具
+ * 不依赖任何容器或并发设施，单线程容器与并发容器都可以直接引用。
+ */
+
+namespace mystl {
+
+// 一段连续空间的视图：指向[first, first + n)
+template <class T>
+struct column_span {
+    typedef T           value_type;
+    typedef T*          iterator;
+    typedef size_t      size_type;
+
+    T *first;
+    size_type n;
+
+    iterator begin() const { return first; }
+    iterator end() const { return first + n; }
+    size_type size() const { return n; }
+    T *data() const { return first; }
+    T &operator[](size_type i) const { return first[i]; }
+};
+
+// 将n上调为2的幂（至少为1）
+inline size_t __ring_round_up(size_t n)
+{
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}
+
+#endif
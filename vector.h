@@ -2,25 +2,49 @@
 #define STL_VECTOR_H_
 
 
+#include <algorithm>
 #include "alloc.h"
 #include "construct.h"
+#include "uninitialized.h"
 
 namespace mystl {
 
-template <class T, class Alloc = mystl::alloc>
-class Vector {
+/**
+ * @brief Vector的空间配置策略
+ * Vector的算法只经由allocate_storage()/deallocate_storage()取得和归还空间。
+ * 缺省策略以simple_alloc<T, Alloc>配置，全是static函数，不占对象空间；
+ * 换一个带状态的策略（例如pmr::Vector保存memory_resource*），其余代码原样共用。
+ */
+template <class T, class Alloc>
+class __vector_alloc_policy {
+protected:
+    typedef mystl::simple_alloc<T, Alloc> data_allocator;
+
+    static T *allocate_storage(size_t n)
+    {
+        return data_allocator::allocate(n);
+    }
+
+    static void deallocate_storage(T *p, size_t n)
+    {
+        data_allocator::deallocate(p, n);
+    }
+};
+
+template <class T, class Alloc = mystl::alloc, class Policy = __vector_alloc_policy<T, Alloc> >
+class Vector : protected Policy {
 public:
     // vector 的嵌套型别
     typedef T value_type;
     typedef value_type* pointer;
     typedef value_type* iterator;
+    typedef const value_type* const_iterator;
     typedef value_type& reference;
+    typedef const value_type& const_reference;
     typedef size_t      size_type;
     typedef ptrdiff_t   difference_type;
 
 protected:
-    // 以下，simple_alloc是SGI STL的空间配置器
-    typedef mystl::simple_alloc<value_type, Alloc> data_allocator;
     iterator start;             // 目前使用空间的头
     iterator finish;            // 目前使用空间的尾
     iterator end_of_storage;    // 目前可用空间的尾
@@ -29,13 +53,13 @@ protected:
     void deallocate()
     {
         if (start) {
-            data_allocator::deallocate(start, end_of_storage - start);
+            this->deallocate_storage(start, end_of_storage - start);
         }
     }
 
     void fill_initialize(size_type n, const T& value)
     {
-        start = allocate_and_fill(n, value); // ???????????????
+        start = allocate_and_fill(n, value); // 配置空间并设初值
         finish = start + n;
         end_of_storage = finish;
     }
@@ -51,7 +75,17 @@ public:
         return finish;
     }
 
-    size_type size()
+    const_iterator begin() const
+    {
+        return start;
+    }
+
+    const_iterator end() const
+    {
+        return finish;
+    }
+
+    size_type size() const
     {
         return size_type(end() - begin());
     }
@@ -71,28 +105,60 @@ public:
         return *(begin() + n);
     }
 
-    vector() : start(0), finish(0), end_of_storage(0) {}
-    vector(size_type n, const T& value)
+    const_reference operator[](size_type n) const
+    {
+        return *(begin() + n);
+    }
+
+    // 只交换三个指针，不搬移元素
+    void swap(Vector& x)
+    {
+        iterator tmp = start;
+        start = x.start;
+        x.start = tmp;
+        tmp = finish;
+        finish = x.finish;
+        x.finish = tmp;
+        tmp = end_of_storage;
+        end_of_storage = x.end_of_storage;
+        x.end_of_storage = tmp;
+    }
+
+    Vector() : start(0), finish(0), end_of_storage(0) {}
+
+    // 以指定的配置策略构造空的Vector，供带状态的策略使用
+    explicit Vector(const Policy& p) : Policy(p), start(0), finish(0), end_of_storage(0) {}
+    Vector(size_type n, const T& value)
     {
         fill_initialize(n, value);
     }
 
-    vector(int n, const T& value)
+    Vector(int n, const T& value)
     {
         fill_initialize(n, value);
     }
 
-    vector(long n, const T& value)
+    Vector(long n, const T& value)
     {
         fill_initialize(n, value);
     }
 
-    explicit vector(size_type n)
+    explicit Vector(size_type n)
     {
         fill_initialize(n, T());
     }
 
-    ~vector()
+    // 深拷贝：配置x.size()个元素的空间并逐一复制
+    Vector(const Vector& x)
+    {
+        start = allocate_and_copy(x.size(), x.begin(), x.end());
+        finish = start + x.size();
+        end_of_storage = finish;
+    }
+
+    Vector& operator=(const Vector& x);
+
+    ~Vector()
     {
         mystl::destroy(start, finish); // 析构
         deallocate(); // 释放内存空间
@@ -121,26 +187,30 @@ public:
     void pop_back()
     {
         --finish;
-        mystl::destory(finish);
+        mystl::destroy(finish);
     }
 
     iterator erase(iterator position)
     {
         if (position + 1 != end()) {
-            copy(poisition + 1, finish, position); // 后续元素往前移动 ???
+            std::copy(position + 1, finish, position); // 后续元素往前移动
         }
         --finish;
         mystl::destroy(finish);
         return position;
     }
 
-  iterator erase(iterator __first, iterator __last) 
-  {
-        iterator __i = copy(__last, _M_finish, __first);
-        destroy(__i, _M_finish);
-        _M_finish = _M_finish - (__last - __first);
-        return __first;
-  }
+    // 清除[first, last)中的所有元素
+    iterator erase(iterator first, iterator last)
+    {
+        iterator i = std::copy(last, finish, first); // 后续元素往前移动
+        mystl::destroy(i, finish);
+        finish = finish - (last - first);
+        return first;
+    }
+
+    // 从position开始，插入n个元素，元素初值为x
+    void insert(iterator position, size_type n, const T& x);
 
     void resize(size_type new_size, const T& x)
     {
@@ -151,9 +221,9 @@ public:
         }
     }
 
-    void resize(size_type new_size) 
+    void resize(size_type new_size)
     {
-        resize(new_size, T()); // 未实现
+        resize(new_size, T());
     }
 
     void clear()
@@ -161,25 +231,187 @@ public:
         erase(begin(), end());
     }
 
-protected:
-    // 配置空间并填满内容
-    iterator allocate_and_fill(size_type n, const T& x)
+    // 预先配置至少n个元素的空间，之后n个以内的push_back不再重新配置
+    void reserve(size_type n)
     {
-        iterator result = data_allocator::allocate(n);
-        uninitialized_fill_n(result, n, x); // 全局函数
-        return result;
+        if (capacity() < n) {
+            const size_type old_size = size();
+            iterator tmp = allocate_and_copy(n, start, finish);
+            mystl::destroy(start, finish);
+            deallocate();
+            start = tmp;
+            finish = tmp + old_size;
+            end_of_storage = start + n;
+        }
     }
 
+    // 把大小调整为n，新增元素只做默认初始化：POD型别不写任何值，
+    // 供read()等直接写入底层空间的场合使用，省去一次无用的填充
+    void resize_default_init(size_type n)
+    {
+        typedef typename __type_traits<T>::is_POD_type is_POD;
+        if (n < size()) {
+            erase(begin() + n, end());
+        } else {
+            reserve(n);
+            __grow_default_init(start + n, is_POD());
+        }
+    }
 
+protected:
+    void __grow_default_init(iterator new_finish, __true_type)
+    {
+        finish = new_finish;
+    }
 
+    void __grow_default_init(iterator new_finish, __false_type)
+    {
+        for (; finish != new_finish; ++finish) {
+            new (finish) T();
+        }
+    }
 
-};
 
+    // 配置空间并填满内容
+    iterator allocate_and_fill(size_type n, const T& x)
+    {
+        iterator result = this->allocate_storage(n);
+        try {
+            mystl::uninitialized_fill_n(result, n, x); // 全局函数
+        } catch (...) {
+            this->deallocate_storage(result, n);
+            throw;
+        }
+        return result;
+    }
 
+    // 配置n个元素的空间，并把[first, last)复制过去
+    template <class ForwardIterator>
+    iterator allocate_and_copy(size_type n, ForwardIterator first, ForwardIterator last)
+    {
+        iterator result = this->allocate_storage(n);
+        try {
+            mystl::uninitialized_copy(first, last, result);
+        } catch (...) {
+            this->deallocate_storage(result, n);
+            throw;
+        }
+        return result;
+    }
+};
 
+template <class T, class Alloc, class Policy>
+void Vector<T, Alloc, Policy>::insert_aux(iterator position, const T& x)
+{
+    if (finish != end_of_storage) {
+        // 还有备用空间，在备用空间起始处构造一个元素，并以vector最后一个元素值为其初值
+        mystl::construct(finish, *(finish - 1));
+        ++finish;
+        T x_copy = x;
+        std::copy_backward(position, finish - 2, finish - 1);
+        *position = x_copy;
+    } else {
+        // 已无备用空间：原大小为0时配置1个元素，否则配置原大小的两倍
+        const size_type old_size = size();
+        const size_type len = old_size != 0 ? 2 * old_size : 1;
+        iterator new_start = this->allocate_storage(len);
+        iterator new_finish = new_start;
+        try {
+            // 将原vector在position之前的内容拷贝到新vector，为新元素设定初值x，再拷贝position之后的内容
+            new_finish = mystl::uninitialized_copy(start, position, new_start);
+            mystl::construct(new_finish, x);
+            ++new_finish;
+            new_finish = mystl::uninitialized_copy(position, finish, new_finish);
+        } catch (...) {
+            // commit or rollback
+            mystl::destroy(new_start, new_finish);
+            this->deallocate_storage(new_start, len);
+            throw;
+        }
+        // 析构并释放原vector
+        mystl::destroy(begin(), end());
+        deallocate();
+        start = new_start;
+        finish = new_finish;
+        end_of_storage = new_start + len;
+    }
+}
 
+/**
+ * @brief 复制赋值
+ * 容量不足时配置新空间；否则在原空间上赋值已有的元素，多出的部分析构或就地构造
+ */
+template <class T, class Alloc, class Policy>
+Vector<T, Alloc, Policy>& Vector<T, Alloc, Policy>::operator=(const Vector& x)
+{
+    if (&x != this) {
+        const size_type xlen = x.size();
+        if (xlen > capacity()) {
+            iterator tmp = allocate_and_copy(xlen, x.begin(), x.end());
+            mystl::destroy(start, finish);
+            deallocate();
+            start = tmp;
+            end_of_storage = start + xlen;
+        } else if (size() >= xlen) {
+            iterator i = std::copy(x.begin(), x.end(), begin());
+            mystl::destroy(i, finish);
+        } else {
+            std::copy(x.begin(), x.begin() + size(), start);
+            mystl::uninitialized_copy(x.begin() + size(), x.end(), finish);
+        }
+        finish = start + xlen;
+    }
+    return *this;
+}
 
+template <class T, class Alloc, class Policy>
+void Vector<T, Alloc, Policy>::insert(iterator position, size_type n, const T& x)
+{
+    if (0 == n) {
+        return;
+    }
+    if (size_type(end_of_storage - finish) >= n) {
+        // 备用空间足够
+        T x_copy = x;
+        const size_type elems_after = finish - position;
+        iterator old_finish = finish;
+        if (elems_after > n) {
+            // 插入点之后的元素个数大于新增元素个数
+            mystl::uninitialized_copy(finish - n, finish, finish);
+            finish += n;
+            std::copy_backward(position, old_finish - n, old_finish);
+            std::fill(position, position + n, x_copy);
+        } else {
+            // 插入点之后的元素个数小于等于新增元素个数
+            mystl::uninitialized_fill_n(finish, n - elems_after, x_copy);
+            finish += n - elems_after;
+            mystl::uninitialized_copy(position, old_finish, finish);
+            finish += elems_after;
+            std::fill(position, old_finish, x_copy);
+        }
+    } else {
+        // 备用空间小于新增元素个数，必须配置额外的内存：新长度为旧长度的两倍，或旧长度+新增元素个数
+        const size_type old_size = size();
+        const size_type len = old_size + (old_size > n ? old_size : n);
+        iterator new_start = this->allocate_storage(len);
+        iterator new_finish = new_start;
+        try {
+            new_finish = mystl::uninitialized_copy(start, position, new_start);
+            new_finish = mystl::uninitialized_fill_n(new_finish, n, x);
+            new_finish = mystl::uninitialized_copy(position, finish, new_finish);
+        } catch (...) {
+            mystl::destroy(new_start, new_finish);
+            this->deallocate_storage(new_start, len);
+            throw;
+        }
+        mystl::destroy(start, finish);
+        deallocate();
+        start = new_start;
+        finish = new_finish;
+        end_of_storage = new_start + len;
+    }
 }
 
+}
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,327 @@
+#ifndef MYSTL_VECTOR_IO_H_
+#define MYSTL_VECTOR_IO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#include "type_traits.h"
+#include "vector.h"
+
+/**
+ * @brief Vector<POD>的零拷贝二进制序列化
+ * 格式为一个24字节的头部，紧接着元素的原始字节：
+ *   magic "MSTV" | version | 是否小端 | 保留 | 元素大小 | 元素个数
+ * 写入时以writev/pwritev把头部和整块缓冲区一次交给内核，读取时直接read进Vector的底层空间，
+ * 中间不经过任何逐元素的转换或临时缓冲区，速度只受磁盘/网络带宽限制。
+ * 与uninitialized_copy相同，以__type_traits<T>::is_POD_type分派：只有POD型别才有对应的版本，
+ * 非POD型别（包括未特化__type_traits的自定义结构）在编译期就找不到匹配的函数。
+ * 所有函数成功时返回0，失败时返回-1并设置errno；头部与当前平台不符（元素大小、字节序），
+ * 或元素个数不合理（溢出、超过文件剩余长度）时errno为EINVAL。
+ */
+
+namespace mystl {
+
+struct __vector_io_header {
+    char magic[4];
+    uint8_t version;
+    uint8_t little_endian;
+    uint16_t reserved0;
+    uint32_t elem_size;
+    uint32_t reserved1;
+    uint64_t count;
+};
+
+static_assert(sizeof(__vector_io_header) == 24, "vector_io header must be 24 bytes");
+
+enum {__VECTOR_IO_VERSION = 1};
+
+inline bool __vector_io_little_endian()
+{
+    const uint16_t one = 1;
+    return 1 == *(const unsigned char *)&one;
+}
+
+inline void __vector_io_make_header(__vector_io_header& h, size_t elem_size, size_t count)
+{
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "MSTV", 4);
+    h.version = __VECTOR_IO_VERSION;
+    h.little_endian = __vector_io_little_endian() ? 1 : 0;
+    h.elem_size = uint32_t(elem_size);
+    h.count = count;
+}
+
+inline int __vector_io_check_header(const __vector_io_header& h, size_t elem_size)
+{
+    if (0 != memcmp(h.magic, "MSTV", 4) || h.version != __VECTOR_IO_VERSION
+        || h.little_endian != (__vector_io_little_endian() ? 1 : 0) || h.elem_size != elem_size) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+enum {__VECTOR_IO_CHUNK = 64 * 1024};  // 从管道/socket读取时，第一次配置的字节数
+
+/**
+ * @brief 检查头部中的元素个数
+ * count来自文件或socket，不可信：count * elem_size溢出size_t时拒绝；
+ * fd是普通文件时，数据部分不得超过data_offset之后剩余的字节数（data_offset为-1表示当前位置）。
+ * 必须在配置空间之前检查，否则溢出后会配置出过小的空间。
+ * regular不为0时，通过它返回fd是否为普通文件
+ */
+inline int __vector_io_check_count(int fd, const __vector_io_header& h, off_t data_offset, bool *regular = 0)
+{
+    if (0 == h.elem_size || h.count > SIZE_MAX / h.elem_size) {
+        errno = EINVAL;
+        return -1;
+    }
+    struct stat st;
+    bool is_reg = 0 == ::fstat(fd, &st) && S_ISREG(st.st_mode);
+    if (is_reg) {
+        if (data_offset < 0) {
+            data_offset = ::lseek(fd, 0, SEEK_CUR);
+        }
+        uint64_t remain = (data_offset >= 0 && data_offset < st.st_size) ? uint64_t(st.st_size - data_offset) : 0;
+        if (h.count * h.elem_size > remain) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    if (regular) {
+        *regular = is_reg;
+    }
+    return 0;
+}
+
+// 写完iov中的全部内容，处理部分写入与EINTR
+inline int __vector_io_writev(int fd, struct iovec *iov, int iovcnt)
+{
+    while (iovcnt > 0) {
+        ssize_t n = ::writev(fd, iov, iovcnt);
+        if (n < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return -1;
+        }
+        // 跳过已经写完的部分
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+// 同__vector_io_writev，但从文件的offset处写起，不移动文件位置
+inline int __vector_io_pwritev(int fd, struct iovec *iov, int iovcnt, off_t offset)
+{
+    while (iovcnt > 0) {
+        ssize_t n = ::pwritev(fd, iov, iovcnt, offset);
+        if (n < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return -1;
+        }
+        offset += n;
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+// 读满len字节；offset为-1时用read()，否则用pread()。提前遇到文件尾时errno为EIO
+inline int __vector_io_read(int fd, void *buf, size_t len, off_t offset)
+{
+    char *p = (char *)buf;
+    while (len > 0) {
+        ssize_t n = offset < 0 ? ::read(fd, p, len) : ::pread(fd, p, len, offset);
+        if (n < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return -1;
+        }
+        if (0 == n) {
+            errno = EIO;
+            return -1;
+        }
+        p += n;
+        len -= n;
+        if (offset >= 0) {
+            offset += n;
+        }
+    }
+    return 0;
+}
+
+template <class T, class Alloc>
+int __serialize(int fd, const Vector<T, Alloc>& v, __true_type)
+{
+    __vector_io_header h;
+    __vector_io_make_header(h, sizeof(T), v.size());
+    struct iovec iov[2];
+    iov[0].iov_base = &h;
+    iov[0].iov_len = sizeof(h);
+    iov[1].iov_base = (void *)v.begin();
+    iov[1].iov_len = v.size() * sizeof(T);
+    return __vector_io_writev(fd, iov, v.empty() ? 1 : 2);
+}
+
+template <class T, class Alloc>
+int __serialize_at(int fd, off_t offset, const Vector<T, Alloc>& v, __true_type)
+{
+    __vector_io_header h;
+    __vector_io_make_header(h, sizeof(T), v.size());
+    struct iovec iov[2];
+    iov[0].iov_base = &h;
+    iov[0].iov_len = sizeof(h);
+    iov[1].iov_base = (void *)v.begin();
+    iov[1].iov_len = v.size() * sizeof(T);
+    return __vector_io_pwritev(fd, iov, v.empty() ? 1 : 2, offset);
+}
+
+template <class T, class Alloc>
+int __deserialize(int fd, off_t offset, Vector<T, Alloc>& v, __true_type)
+{
+    __vector_io_header h;
+    if (__vector_io_read(fd, &h, sizeof(h), offset) < 0 || __vector_io_check_header(h, sizeof(T)) < 0) {
+        return -1;
+    }
+    if (offset >= 0) {
+        offset += sizeof(h);
+    }
+    bool regular;
+    if (__vector_io_check_count(fd, h, offset, &regular) < 0) {
+        return -1;
+    }
+    v.clear(); // 原有内容将被取代，先清空，扩充空间时就不必复制旧元素
+    const size_t count = size_t(h.count);
+    // 普通文件的长度已经核对过，一次配置全部空间；管道/socket无从核对，
+    // 先配置一小块，读满后再倍增，配置的空间至多是实际收到数据的两倍，对端无法凭一个头部让我们配置任意大的空间
+    size_t step = regular ? count : (__VECTOR_IO_CHUNK + sizeof(T) - 1) / sizeof(T);
+    size_t done = 0;
+    while (done < count) {
+        size_t n = count - done < step ? count : done + step;
+        v.resize_default_init(n); // 不初始化，下面直接覆盖
+        off_t pos = offset < 0 ? offset : offset + (off_t)(done * sizeof(T));
+        if (__vector_io_read(fd, v.begin() + done, (n - done) * sizeof(T), pos) < 0) {
+            v.clear();
+            return -1;
+        }
+        done = n;
+        step = done;
+    }
+    return 0;
+}
+
+/**
+ * @brief 把v写到fd的当前位置（文件、管道或socket皆可）
+ */
+template <class T, class Alloc>
+inline int serialize(int fd, const Vector<T, Alloc>& v)
+{
+    typedef typename __type_traits<T>::is_POD_type is_POD;
+    return __serialize(fd, v, is_POD());
+}
+
+/**
+ * @brief 把v写到文件的offset处，不移动文件位置，可供多个线程同时写同一文件的不同区段
+ */
+template <class T, class Alloc>
+inline int serialize_at(int fd, off_t offset, const Vector<T, Alloc>& v)
+{
+    typedef typename __type_traits<T>::is_POD_type is_POD;
+    return __serialize_at(fd, offset, v, is_POD());
+}
+
+// 序列化后占用的字节数，供serialize_at安排多个Vector的位置
+template <class T, class Alloc>
+inline size_t serialized_size(const Vector<T, Alloc>& v)
+{
+    return sizeof(__vector_io_header) + v.size() * sizeof(T);
+}
+
+/**
+ * @brief 从fd的当前位置读回一个Vector，原有内容被取代
+ */
+template <class T, class Alloc>
+inline int deserialize(int fd, Vector<T, Alloc>& v)
+{
+    typedef typename __type_traits<T>::is_POD_type is_POD;
+    return __deserialize(fd, off_t(-1), v, is_POD());
+}
+
+/**
+ * @brief 从文件的offset处读回一个Vector，不移动文件位置
+ */
+template <class T, class Alloc>
+inline int deserialize_at(int fd, off_t offset, Vector<T, Alloc>& v)
+{
+    typedef typename __type_traits<T>::is_POD_type is_POD;
+    return __deserialize(fd, offset, v, is_POD());
+}
+
+#ifdef __linux__
+/**
+ * @brief 把文件in_fd中offset处已序列化的Vector原样发送到out_fd（通常是socket）
+ * 先pread头部得到总长度，再以sendfile在内核中直接搬运，数据不经过用户空间。
+ * 对端以deserialize()读取即可
+ */
+inline int send_serialized(int out_fd, int in_fd, off_t offset)
+{
+    __vector_io_header h;
+    if (__vector_io_read(in_fd, &h, sizeof(h), offset) < 0) {
+        return -1;
+    }
+    if (0 != memcmp(h.magic, "MSTV", 4)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (__vector_io_check_count(in_fd, h, offset + (off_t)sizeof(h)) < 0) {
+        return -1;
+    }
+    size_t len = sizeof(h) + size_t(h.count) * h.elem_size;
+    while (len > 0) {
+        ssize_t n = ::sendfile(out_fd, in_fd, &offset, len);
+        if (n < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return -1;
+        }
+        if (0 == n) {
+            errno = EIO;
+            return -1;
+        }
+        len -= n;
+    }
+    return 0;
+}
+#endif
+
+}
+
+#endif